@@ -0,0 +1,184 @@
+#ifndef BMP_IMAGE_H
+#define BMP_IMAGE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "image.h"
+
+// -------------------------------------------------------
+// BMP Header Structs
+// -------------------------------------------------------
+#pragma pack(push, 1)
+typedef struct {
+  uint16_t bfType;
+  uint32_t bfSize;
+  uint16_t bfReserved1;
+  uint16_t bfReserved2;
+  uint32_t bfOffBits;
+} BMPFileHeader;
+
+typedef struct {
+  uint32_t biSize;
+  int32_t biWidth;
+  int32_t biHeight;
+  uint16_t biPlanes;
+  uint16_t biBitCount;
+  uint32_t biCompression;
+  uint32_t biSizeImage;
+  int32_t biXPelsPerMeter;
+  int32_t biYPelsPerMeter;
+  uint32_t biClrUsed;
+  uint32_t biClrImportant;
+} BMPInfoHeader;
+#pragma pack(pop)
+
+// -------------------------------------------------------
+// An opened 24-bit BMP. The pixel rows are used in place:
+// on POSIX the file is mmap'ed read-only, elsewhere it is
+// read with a single fread. view walks the rows honoring
+// bfOffBits, the 4-byte row stride and top-down storage.
+// -------------------------------------------------------
+typedef struct {
+  BgrView view;
+  int top_down;  // negative biHeight = top-down storage
+  uint8_t *base;
+  size_t len;
+  int mapped;
+} BmpImage;
+
+static inline void bmp_close(BmpImage *img) {
+  if (!img->base) return;
+#if !defined(_WIN32)
+  if (img->mapped) {
+    munmap(img->base, img->len);
+  } else
+#endif
+  {
+    free(img->base);
+  }
+  img->base = NULL;
+}
+
+static inline int bmp_load_file(const char *path, BmpImage *img) {
+#if !defined(_WIN32)
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror("Cannot open input BMP");
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    perror("Cannot stat input BMP");
+    close(fd);
+    return -1;
+  }
+  img->len = (size_t)st.st_size;
+  if (img->len > 0) {
+    void *m = mmap(NULL, img->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      img->base = (uint8_t *)m;
+      img->mapped = 1;
+#ifdef MADV_SEQUENTIAL
+      madvise(m, img->len, MADV_SEQUENTIAL);
+#endif
+      close(fd);
+      return 0;
+    }
+  }
+  close(fd);
+  // Not mappable (pipe, empty file, ...): fall through to stdio
+#endif
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    perror("Cannot open input BMP");
+    return -1;
+  }
+  fseek(fp, 0, SEEK_END);
+  long sz = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  if (sz < 0) sz = 0;
+  img->len = (size_t)sz;
+  img->base = (uint8_t *)malloc(img->len ? img->len : 1);
+  if (!img->base) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    fclose(fp);
+    return -1;
+  }
+  img->len = fread(img->base, 1, img->len, fp);
+  img->mapped = 0;
+  fclose(fp);
+  return 0;
+}
+
+// -------------------------------------------------------
+// Open a 24-bit uncompressed BMP. Returns 0 on success,
+// -1 after printing an error.
+// -------------------------------------------------------
+static inline int bmp_open(const char *path, BmpImage *img) {
+  memset(img, 0, sizeof(*img));
+  if (bmp_load_file(path, img) != 0) return -1;
+
+  BMPFileHeader fh;
+  BMPInfoHeader ih;
+  if (img->len < sizeof(fh) + sizeof(ih)) {
+    fprintf(stderr, "Error: Not a valid BMP file.\n");
+    bmp_close(img);
+    return -1;
+  }
+  memcpy(&fh, img->base, sizeof(fh));
+  memcpy(&ih, img->base + sizeof(fh), sizeof(ih));
+
+  if (fh.bfType != 0x4D42) {
+    fprintf(stderr, "Error: Not a valid BMP file.\n");
+    bmp_close(img);
+    return -1;
+  }
+  if (ih.biBitCount != 24) {
+    fprintf(stderr, "Error: Only 24-bit BMP is supported. Got %d-bit.\n",
+            ih.biBitCount);
+    bmp_close(img);
+    return -1;
+  }
+  if (ih.biCompression != 0) {
+    fprintf(stderr, "Error: Compressed BMP not supported.\n");
+    bmp_close(img);
+    return -1;
+  }
+
+  int src_w = abs(ih.biWidth);
+  int src_h = abs(ih.biHeight);
+  size_t row_stride = ((size_t)src_w * 3 + 3) & ~(size_t)3;
+  if (src_w == 0 || src_h == 0 || fh.bfOffBits > img->len ||
+      row_stride * (size_t)src_h > img->len - fh.bfOffBits) {
+    fprintf(stderr, "Error: BMP pixel data is truncated.\n");
+    bmp_close(img);
+    return -1;
+  }
+
+  // BMP stores bottom-up by default: the top image row is the last
+  // one in the file, and walking down the image walks back in memory.
+  const uint8_t *pixels = img->base + fh.bfOffBits;
+  img->top_down = (ih.biHeight < 0);
+  img->view.w = src_w;
+  img->view.h = src_h;
+  if (img->top_down) {
+    img->view.row0 = pixels;
+    img->view.stride = (ptrdiff_t)row_stride;
+  } else {
+    img->view.row0 = pixels + row_stride * (size_t)(src_h - 1);
+    img->view.stride = -(ptrdiff_t)row_stride;
+  }
+  return 0;
+}
+
+#endif  // BMP_IMAGE_H
@@ -1,220 +1,730 @@
+// Build: cc -O2 -o bmp_to_hex bmp_to_hex.c -pthread
+
+#include <dirent.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#include "bmp_image.h"
+#include "bounded_queue.h"
+#include "converter.h"
+#include "frame_cache.h"
+#include "frame_pool.h"
+#include "frame_seq.h"
+#include "frame_io.h"
+#include "parallel.h"
+#include "rgb565.h"
+#include "stage_stats.h"
 
-#define OUT_WIDTH 320
-#define OUT_HEIGHT 240
+// Progress lines: stdout, or stderr when --stats=- takes it
+static FILE *log_fp;
 
 // -------------------------------------------------------
-// BMP Header Structs
+// Write output file (geometry header + pixels)
+//  .hex : "// RGB565 WxH", then each line 4 uppercase hex
+//         digits = one pixel (76800 lines at 320x240)
+//  .bin : 16-byte header, then one block of little-endian
+//         uint16 words
+//  .raw : the block only
+//  .r5s : a one-frame sequence container (frame_seq.h)
+// Timed as the write stage when stats is set.
+// Returns 0 on success, -1 after printing an error.
 // -------------------------------------------------------
-#pragma pack(push, 1)
-typedef struct {
-  uint16_t bfType;
-  uint32_t bfSize;
-  uint16_t bfReserved1;
-  uint16_t bfReserved2;
-  uint32_t bfOffBits;
-} BMPFileHeader;
-
-typedef struct {
-  uint32_t biSize;
-  int32_t biWidth;
-  int32_t biHeight;
-  uint16_t biPlanes;
-  uint16_t biBitCount;
-  uint32_t biCompression;
-  uint32_t biSizeImage;
-  int32_t biXPelsPerMeter;
-  int32_t biYPelsPerMeter;
-  uint32_t biClrUsed;
-  uint32_t biClrImportant;
-} BMPInfoHeader;
-#pragma pack(pop)
+static int write_frame_file(Stats *stats, const char *path, uint16_t *frame,
+                            int w, int h) {
+  double t0 = stats_clock(stats);
+  uint64_t bytes = 0;
+  if (frame_seq_path(path)) {
+    FrameSeqWriter seq;
+    if (frame_seq_create(&seq, path, w, h) != 0) return -1;
+    int err = frame_seq_append(&seq, frame);
+    bytes = FRAME_SEQ_HEADER_BYTES + seq.coded_bytes +
+            FRAME_SEQ_INDEX_ENTRY_BYTES;
+    if (frame_seq_finish(&seq) != 0) err = -1;
+    if (err) {
+      fprintf(stderr, "Error: failed writing %s\n", path);
+      return -1;
+    }
+  } else if (write_frame_path(path, frame, w, h, &bytes) != 0) {
+    return -1;
+  }
+  stats_add(stats, STAGE_FRAME_WRITE, t0, (uint64_t)w * h, bytes);
+  return 0;
+}
 
 // -------------------------------------------------------
-// RGB pixel struct
+// Cache key (--cache): the BMP file bytes and every setting
+// that changes the output frame. --planar and --threads
+// give the same frame and are left out; the output format
+// is the entry's extension.
 // -------------------------------------------------------
 typedef struct {
-  uint8_t r, g, b;
-} Pixel;
+  char tool[8];
+  int32_t out_w, out_h;
+  int32_t mode;
+  int32_t blur;
+} FrameKeyConfig;
 
-// -------------------------------------------------------
-// Convert 8-bit R,G,B → 16-bit RGB565
-// Layout: [15:11]=R, [10:5]=G, [4:0]=B
-// -------------------------------------------------------
-static inline uint16_t to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
-  uint16_t r5 = (r >> 3) & 0x1F;
-  uint16_t g6 = (g >> 2) & 0x3F;
-  uint16_t b5 = (b >> 3) & 0x1F;
-  return (uint16_t)((r5 << 11) | (g6 << 5) | b5);
+static uint64_t frame_key(const Converter *c, const BmpImage *bmp) {
+  FrameKeyConfig k;
+  memset(&k, 0, sizeof(k));
+  memcpy(k.tool, "b2h", 4);
+  k.out_w = c->out_w;
+  k.out_h = c->out_h;
+  k.mode = (int32_t)c->mode;
+  k.blur = c->blur;
+  return frame_cache_key(bmp->base, bmp->len, &k, sizeof(k));
+}
+
+// Hash bmp and look its frame up, timed as the cache stage.
+// Returns whether an entry with extension ext exists.
+static int frame_key_lookup(const Converter *c, FrameCache *cache,
+                            const BmpImage *bmp, const char *ext,
+                            uint64_t *key) {
+  double t0 = stats_clock(c->stats);
+  *key = frame_key(c, bmp);
+  int hit = frame_cache_has(cache, *key, ext);
+  stats_add(c->stats, STAGE_CACHE, t0, 0, bmp->len);
+  return hit;
+}
+
+// Extension of an output path, as its cache entries use it
+static const char *out_ext(const char *path) {
+  return frame_seq_path(path) ? ".r5s"
+                              : frame_format_ext(frame_format_from_path(path));
 }
 
 // -------------------------------------------------------
-// Bilinear resize: src (src_w x src_h) → dst (dst_w x dst_h)
+// Single frame: input.bmp → output.hex|.bin
+// With a cache, an input seen before under the same
+// settings is copied from its entry instead of converted.
 // -------------------------------------------------------
-Pixel *resize_bilinear(Pixel *src, int src_w, int src_h, int dst_w, int dst_h) {
-  Pixel *dst = (Pixel *)malloc(dst_w * dst_h * sizeof(Pixel));
-  if (!dst) return NULL;
-
-  float x_scale = (float)src_w / dst_w;
-  float y_scale = (float)src_h / dst_h;
-
-  for (int dst_y = 0; dst_y < dst_h; dst_y++) {
-    for (int dst_x = 0; dst_x < dst_w; dst_x++) {
-      float src_xf = dst_x * x_scale;
-      float src_yf = dst_y * y_scale;
-
-      int x0 = (int)src_xf;
-      int y0 = (int)src_yf;
-      int x1 = x0 + 1 < src_w ? x0 + 1 : x0;
-      int y1 = y0 + 1 < src_h ? y0 + 1 : y0;
-
-      float dx = src_xf - x0;
-      float dy = src_yf - y0;
-
-      Pixel p00 = src[y0 * src_w + x0];
-      Pixel p10 = src[y0 * src_w + x1];
-      Pixel p01 = src[y1 * src_w + x0];
-      Pixel p11 = src[y1 * src_w + x1];
-
-      // Bilinear interpolation for each channel
-      dst[dst_y * dst_w + dst_x].r =
-          (uint8_t)(p00.r * (1 - dx) * (1 - dy) + p10.r * dx * (1 - dy) +
-                    p01.r * (1 - dx) * dy + p11.r * dx * dy);
-      dst[dst_y * dst_w + dst_x].g =
-          (uint8_t)(p00.g * (1 - dx) * (1 - dy) + p10.g * dx * (1 - dy) +
-                    p01.g * (1 - dx) * dy + p11.g * dx * dy);
-      dst[dst_y * dst_w + dst_x].b =
-          (uint8_t)(p00.b * (1 - dx) * (1 - dy) + p10.b * dx * (1 - dy) +
-                    p01.b * (1 - dx) * dy + p11.b * dx * dy);
-    }
+static int convert_one(Converter *c, FrameCache *cache, const char *in_path,
+                       const char *out_path) {
+  // Open BMP: pixel rows are mapped, not copied
+  BmpImage bmp;
+  double t0 = stats_clock(c->stats);
+  if (bmp_open(in_path, &bmp) != 0) return 1;
+  stats_add(c->stats, STAGE_BMP_READ, t0,
+            (uint64_t)bmp.view.w * bmp.view.h, bmp.len);
+
+  int src_w = bmp.view.w;
+  int src_h = bmp.view.h;
+
+  fprintf(log_fp, "Input image: %dx%d pixels (24-bit BMP)\n", src_w, src_h);
+
+  uint64_t key = 0;
+  if (cache && frame_key_lookup(c, cache, &bmp, out_ext(out_path), &key)) {
+    bmp_close(&bmp);
+    t0 = stats_clock(c->stats);
+    uint64_t bytes = 0;
+    if (frame_cache_fetch(cache, key, out_ext(out_path), out_path, &bytes) !=
+        0)
+      return 1;
+    stats_add(c->stats, STAGE_FRAME_WRITE, t0, converter_pixels(c), bytes);
+    if (c->stats) c->stats->frames++;
+    fprintf(log_fp, "Unchanged; copied %s from %s/%016llx%s\n", out_path,
+            cache->dir, (unsigned long long)key, out_ext(out_path));
+    return 0;
+  }
+
+  size_t npix = converter_pixels(c);
+  uint16_t *frame =
+      (uint16_t *)frame_pool_get(c->bufs, npix * sizeof(uint16_t));
+  Pixel *scratch =
+      c->blur ? NULL : (Pixel *)frame_pool_get(c->bufs, npix * sizeof(Pixel));
+  if (!frame || (!c->blur && !scratch)) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    frame_pool_put(c->bufs, frame);
+    frame_pool_put(c->bufs, scratch);
+    bmp_close(&bmp);
+    return 1;
+  }
+
+  // Resize to out_w x out_h (skip if already correct size) and
+  // convert to RGB565
+  if (src_w == c->out_w && src_h == c->out_h) {
+    fprintf(log_fp, "Image already %dx%d, skipping resize.\n", c->out_w,
+            c->out_h);
+  } else {
+    ResizeMode used = converter_engine(c, &bmp.view);
+    if (used != converter_mode(c, src_w, src_h))
+      fprintf(log_fp, "Note: area filter cannot take %dx%d -> %dx%d\n",
+              src_w, src_h, c->out_w, c->out_h);
+    fprintf(log_fp, "Resizing to %dx%d using %s...\n", c->out_w, c->out_h,
+            resize_mode_name(used));
+  }
+  if (c->blur) fprintf(log_fp, "Blurring (3x3, fused with the resize)...\n");
+  int err = converter_run(c, &bmp.view, scratch, frame);
+  bmp_close(&bmp);
+  frame_pool_put(c->bufs, scratch);
+  if (err) {
+    fprintf(stderr, "Resize failed.\n");
+    frame_pool_put(c->bufs, frame);
+    return 1;
   }
-  return dst;
+
+  err = write_frame_file(c->stats, out_path, frame, c->out_w, c->out_h);
+  frame_pool_put(c->bufs, frame);
+  if (err) return 1;
+  if (c->stats) c->stats->frames++;
+  // A failed store only costs the next run a conversion
+  if (cache) frame_cache_store(cache, key, out_ext(out_path), out_path);
+
+  fprintf(log_fp, "Done. Wrote %zu pixels to %s\n", npix, out_path);
+  if (!frame_seq_path(out_path) &&
+      frame_format_from_path(out_path) == FRAME_FMT_HEX)
+    fprintf(log_fp, "Load in Verilog with: $readmemh(\"%s\", frame_buffer);\n",
+            out_path);
+  return 0;
 }
 
 // -------------------------------------------------------
-// Main
+// Batch mode
+//
+// Three stages connected by bounded queues, so file I/O
+// overlaps compute:
+//   decode thread : map + validate the next BMP
+//   main thread   : resize + pack (banded over the pool)
+//   write thread  : encode + write the frame file
+// Frame slots (output buffers + the mapped BMP) circulate
+// through a free queue, and the converter's scratch comes
+// from its frame pool, so steady state allocates nothing.
+// A missing out_dir is created, and inputs whose stems
+// would name the same output file are rejected before any
+// frame is written. An out_dir ending in .r5s is instead
+// one sequence file (frame_seq.h) holding the frames in
+// input order.
+// With a cache, the decode thread also hashes each BMP;
+// frames with an entry skip the main thread and are copied
+// (or, into a .r5s, loaded from a .raw entry) by the write
+// thread, which also stores the new ones.
 // -------------------------------------------------------
-int main(int argc, char *argv[]) {
-  if (argc < 3) {
-    fprintf(stderr, "Usage: %s input.bmp output.hex\n", argv[0]);
-    fprintf(stderr, "  input.bmp  : any 24-bit BMP (any resolution)\n");
-    fprintf(stderr,
-            "  output.hex : RGB565 hex file for $readmemh in Verilog\n");
-    return 1;
+#define BATCH_QUEUE_DEPTH 2
+#define BATCH_SLOTS (3 * BATCH_QUEUE_DEPTH)
+
+typedef struct {
+  const char *in_path;
+  char out_path[4096];
+  BmpImage bmp;
+  int ok;
+  int cached;    // frame comes from the cache entry key
+  uint64_t key;  // set when there is a cache
+  Pixel *scratch;
+  uint16_t *frame;
+} FrameSlot;
+
+typedef struct {
+  char **items;
+  int count, cap;
+} PathList;
+
+static int path_list_add(PathList *l, const char *s, size_t n) {
+  if (l->count == l->cap) {
+    int cap = l->cap ? 2 * l->cap : 64;
+    char **items = (char **)realloc(l->items, (size_t)cap * sizeof(char *));
+    if (!items) return -1;
+    l->items = items;
+    l->cap = cap;
   }
+  char *copy = (char *)malloc(n + 1);
+  if (!copy) return -1;
+  memcpy(copy, s, n);
+  copy[n] = '\0';
+  l->items[l->count++] = copy;
+  return 0;
+}
+
+static void path_list_free(PathList *l) {
+  for (int i = 0; i < l->count; i++) free(l->items[i]);
+  free(l->items);
+  memset(l, 0, sizeof(*l));
+}
 
-  // -------------------------------------------------------
-  // Open BMP and read headers
-  // -------------------------------------------------------
-  FILE *fp = fopen(argv[1], "rb");
+static int cmp_str(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// A directory contributes its *.bmp files in name order; any
+// other path is read as a list file, one BMP path per line
+// (blank lines and lines starting with '#' are skipped).
+static int collect_inputs(const char *src, PathList *l) {
+  struct stat st;
+  if (stat(src, &st) != 0) {
+    perror(src);
+    return -1;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    DIR *d = opendir(src);
+    if (!d) {
+      perror(src);
+      return -1;
+    }
+    struct dirent *e;
+    char path[4096];
+    while ((e = readdir(d)) != NULL) {
+      if (!path_has_ext(e->d_name, ".bmp")) continue;
+      int n = snprintf(path, sizeof(path), "%s/%s", src, e->d_name);
+      if (n < 0 || (size_t)n >= sizeof(path) ||
+          path_list_add(l, path, (size_t)n) != 0) {
+        closedir(d);
+        return -1;
+      }
+    }
+    closedir(d);
+    qsort(l->items, (size_t)l->count, sizeof(char *), cmp_str);
+    return 0;
+  }
+
+  FILE *fp = fopen(src, "r");
   if (!fp) {
-    perror("Cannot open input BMP");
-    return 1;
+    perror(src);
+    return -1;
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), fp)) {
+    char *s = line;
+    while (*s == ' ' || *s == '\t') s++;
+    size_t n = strcspn(s, "\r\n");
+    while (n > 0 && (s[n - 1] == ' ' || s[n - 1] == '\t')) n--;
+    if (n == 0 || s[0] == '#') continue;
+    if (path_list_add(l, s, n) != 0) {
+      fclose(fp);
+      return -1;
+    }
   }
+  fclose(fp);
+  return 0;
+}
 
-  BMPFileHeader fh;
-  BMPInfoHeader ih;
-  fread(&fh, sizeof(BMPFileHeader), 1, fp);
-  fread(&ih, sizeof(BMPInfoHeader), 1, fp);
+// out_dir/<input basename without extension><ext> into
+// p[n]. Returns 0, or -1 if it does not fit.
+static int make_out_path(char *p, size_t n, const char *out_dir,
+                         const char *in_path, const char *ext) {
+  const char *base = strrchr(in_path, '/');
+  base = base ? base + 1 : in_path;
+  const char *dot = strrchr(base, '.');
+  size_t stem = dot ? (size_t)(dot - base) : strlen(base);
+  int len = snprintf(p, n, "%s/%.*s%s", out_dir, (int)stem, base, ext);
+  return len < 0 || (size_t)len >= n ? -1 : 0;
+}
 
-  if (fh.bfType != 0x4D42) {
-    fprintf(stderr, "Error: Not a valid BMP file.\n");
-    fclose(fp);
-    return 1;
+typedef struct {
+  const char *in_path;
+  const char *out_path;
+} OutName;
+
+static int cmp_out_name(const void *a, const void *b) {
+  return strcmp(((const OutName *)a)->out_path,
+                ((const OutName *)b)->out_path);
+}
+
+// Output files are named after the input stems, so a.bmp
+// and a.BMP (or two a.bmp in a list file) would overwrite
+// each other. Checks every output path up front. Returns 0,
+// or -1 after naming the first clash or overlong path.
+static int check_out_names(const PathList *inputs, const char *out_dir,
+                           const char *ext) {
+  PathList outs = {0};
+  OutName *names =
+      (OutName *)malloc((size_t)inputs->count * sizeof(OutName));
+  int err = names ? 0 : -1;
+  if (err) fprintf(stderr, "Memory allocation failed.\n");
+  for (int i = 0; i < inputs->count && !err; i++) {
+    char path[4096];
+    if (make_out_path(path, sizeof(path), out_dir, inputs->items[i], ext) !=
+        0) {
+      fprintf(stderr, "Output path too long: %s\n", inputs->items[i]);
+      err = -1;
+    } else if (path_list_add(&outs, path, strlen(path)) != 0) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      err = -1;
+    } else {
+      names[i].in_path = inputs->items[i];
+      names[i].out_path = outs.items[i];
+    }
   }
-  if (ih.biBitCount != 24) {
-    fprintf(stderr, "Error: Only 24-bit BMP is supported. Got %d-bit.\n",
-            ih.biBitCount);
-    fclose(fp);
-    return 1;
+  if (!err) {
+    qsort(names, (size_t)inputs->count, sizeof(OutName), cmp_out_name);
+    for (int i = 1; i < inputs->count && !err; i++) {
+      if (strcmp(names[i - 1].out_path, names[i].out_path) != 0) continue;
+      fprintf(stderr, "Error: %s and %s would both write %s\n",
+              names[i - 1].in_path, names[i].in_path, names[i].out_path);
+      err = -1;
+    }
   }
-  if (ih.biCompression != 0) {
-    fprintf(stderr, "Error: Compressed BMP not supported.\n");
-    fclose(fp);
-    return 1;
+  free(names);
+  path_list_free(&outs);
+  return err;
+}
+
+// A missing out_dir is created (its parent must exist);
+// an existing one must be a directory. Returns 0, or -1
+// after printing an error.
+static int prepare_out_dir(const char *out_dir) {
+  struct stat st;
+  if (stat(out_dir, &st) == 0) {
+    if (S_ISDIR(st.st_mode)) return 0;
+    fprintf(stderr, "Error: %s is not a directory\n", out_dir);
+    return -1;
+  }
+  if (mkdir(out_dir, 0777) != 0) {
+    perror(out_dir);
+    return -1;
   }
+  return 0;
+}
 
-  int src_w = abs(ih.biWidth);
-  int src_h = abs(ih.biHeight);
-  int top_down = (ih.biHeight < 0);  // negative height = top-down storage
+typedef struct {
+  const Converter *conv;
+  PathList *inputs;
+  FrameSeqWriter *seq;  // NULL: one file per frame
+  FrameCache *cache;    // NULL: no --cache
+  const char *entry_ext;  // extension of the cache entries
+  BoundedQueue free_q, decode_q, write_q;
+  int failures;  // written by the write thread only
+  int written;
+} Batch;
 
-  printf("Input image: %dx%d pixels (24-bit BMP)\n", src_w, src_h);
+static void *batch_decode_main(void *arg) {
+  Batch *b = (Batch *)arg;
+  for (int i = 0; i < b->inputs->count; i++) {
+    FrameSlot *s = (FrameSlot *)bq_pop(&b->free_q);
+    s->in_path = b->inputs->items[i];
+    double t0 = stats_clock(b->conv->stats);
+    s->ok = bmp_open(s->in_path, &s->bmp) == 0;
+    if (s->ok)
+      stats_add(b->conv->stats, STAGE_BMP_READ, t0,
+                (uint64_t)s->bmp.view.w * s->bmp.view.h, s->bmp.len);
+    s->cached = s->ok && b->cache &&
+                frame_key_lookup(b->conv, b->cache, &s->bmp, b->entry_ext,
+                                 &s->key);
+    if (s->cached) bmp_close(&s->bmp);
+    bq_push(&b->decode_q, s);
+  }
+  bq_close(&b->decode_q);
+  return NULL;
+}
 
-  // -------------------------------------------------------
-  // Read all pixel rows into a flat Pixel array
-  // -------------------------------------------------------
-  int row_stride = (src_w * 3 + 3) & ~3;  // BMP rows padded to 4 bytes
-  uint8_t *row_buf = (uint8_t *)malloc(row_stride);
-  Pixel *src_pixels = (Pixel *)malloc(src_w * src_h * sizeof(Pixel));
-  if (!row_buf || !src_pixels) {
-    fprintf(stderr, "Memory allocation failed.\n");
-    return 1;
+// Write out one slot in order: append it to the sequence,
+// or write (or copy from the cache) its frame file. Returns
+// 0, or -1 after printing an error.
+static int batch_write_slot(Batch *b, FrameSlot *s) {
+  const Converter *c = b->conv;
+  double t0 = stats_clock(c->stats);
+  if (b->seq) {
+    if (s->cached && frame_cache_load(b->cache, s->key, s->frame,
+                                      converter_pixels(c)) != 0)
+      return -1;
+    uint64_t before = b->seq->coded_bytes;
+    if (frame_seq_append(b->seq, s->frame) != 0) {
+      fprintf(stderr, "Error: failed appending %s\n", s->in_path);
+      return -1;
+    }
+    stats_add(c->stats, STAGE_FRAME_WRITE, t0, converter_pixels(c),
+              b->seq->coded_bytes - before);
+    if (b->cache && !s->cached)
+      frame_cache_store_frame(b->cache, s->key, s->frame, c->out_w, c->out_h);
+    fprintf(log_fp, "%s -> frame %u%s\n", s->in_path, b->seq->count - 1,
+            s->cached ? " (cached)" : "");
+    return 0;
+  }
+  if (s->cached) {
+    uint64_t bytes = 0;
+    if (frame_cache_fetch(b->cache, s->key, b->entry_ext, s->out_path,
+                          &bytes) != 0)
+      return -1;
+    stats_add(c->stats, STAGE_FRAME_WRITE, t0, converter_pixels(c), bytes);
+  } else {
+    if (write_frame_file(c->stats, s->out_path, s->frame, c->out_w,
+                         c->out_h) != 0)
+      return -1;
+    if (b->cache)
+      frame_cache_store(b->cache, s->key, b->entry_ext, s->out_path);
   }
+  fprintf(log_fp, "%s -> %s%s\n", s->in_path, s->out_path,
+          s->cached ? " (cached)" : "");
+  return 0;
+}
 
-  fseek(fp, fh.bfOffBits, SEEK_SET);
+static void *batch_write_main(void *arg) {
+  Batch *b = (Batch *)arg;
+  FrameSlot *s;
+  while ((s = (FrameSlot *)bq_pop(&b->write_q)) != NULL) {
+    if (s->ok && batch_write_slot(b, s) == 0) {
+      b->written++;
+      if (b->conv->stats) b->conv->stats->frames++;
+    } else {
+      b->failures++;
+    }
+    bq_push(&b->free_q, s);
+  }
+  return NULL;
+}
 
-  for (int row = 0; row < src_h; row++) {
-    fread(row_buf, 1, row_stride, fp);
+static int convert_batch(Converter *c, FrameCache *cache, const char *src,
+                         const char *out_dir, const char *ext) {
+  PathList inputs = {0};
+  if (collect_inputs(src, &inputs) != 0) {
+    path_list_free(&inputs);
+    return 1;
+  }
+  if (inputs.count == 0) {
+    fprintf(stderr, "No input BMPs found in %s\n", src);
+    path_list_free(&inputs);
+    return 1;
+  }
 
-    // BMP stores bottom-up by default (unless top_down flag set)
-    int dst_row = top_down ? row : (src_h - 1 - row);
+  if (!frame_seq_path(out_dir) &&
+      (check_out_names(&inputs, out_dir, ext) != 0 ||
+       prepare_out_dir(out_dir) != 0)) {
+    path_list_free(&inputs);
+    return 1;
+  }
 
-    for (int col = 0; col < src_w; col++) {
-      // BMP channel order is B, G, R
-      src_pixels[dst_row * src_w + col].r = row_buf[col * 3 + 2];
-      src_pixels[dst_row * src_w + col].g = row_buf[col * 3 + 1];
-      src_pixels[dst_row * src_w + col].b = row_buf[col * 3 + 0];
+  Batch b;
+  memset(&b, 0, sizeof(b));
+  b.conv = c;
+  b.inputs = &inputs;
+  b.cache = cache;
+  b.entry_ext = frame_seq_path(out_dir) ? ".raw" : ext;
+  FrameSeqWriter seq;
+  if (frame_seq_path(out_dir)) {
+    if (frame_seq_create(&seq, out_dir, c->out_w, c->out_h) != 0) {
+      path_list_free(&inputs);
+      return 1;
     }
+    b.seq = &seq;
+  }
+  FrameSlot slots[BATCH_SLOTS];
+  memset(slots, 0, sizeof(slots));
+  int init_err = bq_init(&b.free_q, BATCH_SLOTS) |
+                 bq_init(&b.decode_q, BATCH_QUEUE_DEPTH) |
+                 bq_init(&b.write_q, BATCH_QUEUE_DEPTH);
+  for (int i = 0; i < BATCH_SLOTS && !init_err; i++) {
+    slots[i].frame = (uint16_t *)frame_pool_get(
+        c->bufs, converter_pixels(c) * sizeof(uint16_t));
+    if (!c->blur)
+      slots[i].scratch = (Pixel *)frame_pool_get(
+          c->bufs, converter_pixels(c) * sizeof(Pixel));
+    if (!slots[i].frame || (!c->blur && !slots[i].scratch)) init_err = -1;
+    bq_push(&b.free_q, &slots[i]);
   }
-  fclose(fp);
-  free(row_buf);
-
-  // -------------------------------------------------------
-  // Resize to 320x240 (skip if already correct size)
-  // -------------------------------------------------------
-  Pixel *out_pixels = NULL;
 
-  if (src_w == OUT_WIDTH && src_h == OUT_HEIGHT) {
-    printf("Image already 320x240, skipping resize.\n");
-    out_pixels = src_pixels;
+  pthread_t decode_th, write_th;
+  if (init_err || pthread_create(&decode_th, NULL, batch_decode_main, &b)) {
+    fprintf(stderr, "Batch setup failed.\n");
+    init_err = -1;
+  } else if (pthread_create(&write_th, NULL, batch_write_main, &b)) {
+    // Drain the decoder so it can be joined, then give up
+    fprintf(stderr, "Batch setup failed.\n");
+    FrameSlot *s;
+    while ((s = (FrameSlot *)bq_pop(&b.decode_q)) != NULL) {
+      if (s->ok && !s->cached) bmp_close(&s->bmp);
+      bq_push(&b.free_q, s);
+    }
+    pthread_join(decode_th, NULL);
+    init_err = -1;
   } else {
-    printf("Resizing to %dx%d using bilinear interpolation...\n", OUT_WIDTH,
-           OUT_HEIGHT);
-    out_pixels =
-        resize_bilinear(src_pixels, src_w, src_h, OUT_WIDTH, OUT_HEIGHT);
-    free(src_pixels);
-    if (!out_pixels) {
-      fprintf(stderr, "Resize failed.\n");
-      return 1;
+    FrameSlot *s;
+    while ((s = (FrameSlot *)bq_pop(&b.decode_q)) != NULL) {
+      if (s->ok && !s->cached) {
+        if (converter_run(c, &s->bmp.view, s->scratch, s->frame) != 0) {
+          fprintf(stderr, "Resize failed: %s\n", s->in_path);
+          s->ok = 0;
+        }
+        bmp_close(&s->bmp);
+      }
+      if (s->ok && !b.seq &&
+          make_out_path(s->out_path, sizeof(s->out_path), out_dir,
+                        s->in_path, ext) != 0) {
+        fprintf(stderr, "Output path too long: %s\n", s->in_path);
+        s->ok = 0;
+      }
+      bq_push(&b.write_q, s);
+    }
+    bq_close(&b.write_q);
+    pthread_join(decode_th, NULL);
+    pthread_join(write_th, NULL);
+    fprintf(log_fp, "Batch done. Wrote %d of %d frames to %s\n", b.written,
+            inputs.count, out_dir);
+    if (cache)
+      fprintf(log_fp, "Cache: %lu unchanged, %lu converted\n", cache->hits,
+              cache->misses);
+  }
+  if (b.seq) {
+    if (b.seq->raw_bytes)
+      fprintf(log_fp,
+              "Sequence: %llu bytes of frame data for %llu raw (%.1f%%)\n",
+              (unsigned long long)b.seq->coded_bytes,
+              (unsigned long long)b.seq->raw_bytes,
+              100.0 * (double)b.seq->coded_bytes / (double)b.seq->raw_bytes);
+    if (frame_seq_finish(b.seq) != 0) {
+      fprintf(stderr, "Error: failed writing %s\n", out_dir);
+      init_err = -1;
     }
   }
 
-  // -------------------------------------------------------
-  // Convert to RGB565 and write hex file
-  // Each line: 4 uppercase hex digits = one 16-bit pixel
-  // Total lines: 320 * 240 = 76800
-  // -------------------------------------------------------
-  FILE *out = fopen(argv[2], "w");
-  if (!out) {
-    perror("Cannot open output file");
-    return 1;
+  for (int i = 0; i < BATCH_SLOTS; i++) {
+    frame_pool_put(c->bufs, slots[i].frame);
+    frame_pool_put(c->bufs, slots[i].scratch);
   }
+  bq_destroy(&b.free_q);
+  bq_destroy(&b.decode_q);
+  bq_destroy(&b.write_q);
+  path_list_free(&inputs);
+  return (init_err || b.failures) ? 1 : 0;
+}
 
-  for (int y = 0; y < OUT_HEIGHT; y++) {
-    for (int x = 0; x < OUT_WIDTH; x++) {
-      Pixel p = out_pixels[y * OUT_WIDTH + x];
-      uint16_t rgb565 = to_rgb565(p.r, p.g, p.b);
-      fprintf(out, "%04X\n", rgb565);
+// -------------------------------------------------------
+// Main
+// -------------------------------------------------------
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options] input.bmp output.hex|.bin|.raw|.r5s\n", prog);
+  fprintf(stderr,
+          "       %s [options] --batch input_dir|list.txt out_dir|out.r5s\n",
+          prog);
+  fprintf(stderr, "  input.bmp  : any 24-bit BMP (any resolution)\n");
+  fprintf(stderr,
+          "  output.hex : RGB565 hex file for $readmemh in Verilog\n");
+  fprintf(stderr,
+          "  output.bin : packed little-endian RGB565 with a geometry "
+          "header\n");
+  fprintf(stderr, "  output.raw : packed little-endian RGB565, no header\n");
+  fprintf(stderr,
+          "  output.r5s : run-length/delta coded frame sequence, read by "
+          "convert\n"
+          "               (--batch writes every frame into one .r5s)\n");
+  fprintf(stderr, "Options:\n");
+  fprintf(stderr,
+          "  --size=WxH           : output geometry (default: 320x240)\n");
+  fprintf(stderr,
+          "  --resize=MODE        : auto|fixed|float|area (default: auto,\n"
+          "                         area filter beyond 2x reduction, else "
+          "fixed bilinear)\n");
+  fprintf(stderr,
+          "  --blur               : write the 3x3-blurred frame (what the "
+          "core\n"
+          "                         produces) in one fused pass\n");
+  fprintf(stderr,
+          "  --planar             : run fixed bilinear on R/G/B planes "
+          "(same output)\n");
+  fprintf(stderr,
+          "  --threads=N          : worker threads, 0 = one per CPU "
+          "(default: 1; unused by --blur)\n");
+  fprintf(stderr,
+          "  --batch              : convert every BMP in a directory or "
+          "list file\n");
+  fprintf(stderr,
+          "  --format=hex|bin|raw : batch output format (default: hex)\n");
+  fprintf(stderr,
+          "  --stats[=FILE.json]  : per-stage times and rates; with a file "
+          "(- = stdout),\n"
+          "                         also as JSON (- moves progress to "
+          "stderr)\n");
+  fprintf(stderr,
+          "  --cache=DIR          : reuse frames of inputs converted before "
+          "with the\n"
+          "                         same settings; store new ones in DIR\n");
+}
+
+int main(int argc, char *argv[]) {
+  const char *in_path = NULL;
+  const char *out_path = NULL;
+  int out_w = FRAME_DEFAULT_WIDTH;
+  int out_h = FRAME_DEFAULT_HEIGHT;
+  ResizeMode resize_mode = RESIZE_AUTO;
+  int nthreads = 1;
+  int batch = 0;
+  int blur = 0;
+  int planar = 0;
+  const char *batch_ext = ".hex";
+  int stats = 0;
+  const char *stats_json = NULL;
+  const char *cache_dir = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--size=", 7) == 0) {
+      if (parse_geometry(argv[i] + 7, &out_w, &out_h) != 0) {
+        fprintf(stderr, "Bad --size (expected WxH): %s\n", argv[i] + 7);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--resize=auto") == 0) {
+      resize_mode = RESIZE_AUTO;
+    } else if (strcmp(argv[i], "--resize=fixed") == 0) {
+      resize_mode = RESIZE_FIXED;
+    } else if (strcmp(argv[i], "--resize=float") == 0) {
+      resize_mode = RESIZE_FLOAT;
+    } else if (strcmp(argv[i], "--resize=area") == 0) {
+      resize_mode = RESIZE_AREA;
+    } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+      nthreads = atoi(argv[i] + 10);
+    } else if (strcmp(argv[i], "--blur") == 0) {
+      blur = 1;
+    } else if (strcmp(argv[i], "--planar") == 0) {
+      planar = 1;
+    } else if (strcmp(argv[i], "--batch") == 0) {
+      batch = 1;
+    } else if (strcmp(argv[i], "--format=hex") == 0) {
+      batch_ext = ".hex";
+    } else if (strcmp(argv[i], "--format=bin") == 0) {
+      batch_ext = ".bin";
+    } else if (strcmp(argv[i], "--format=raw") == 0) {
+      batch_ext = ".raw";
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      stats = 1;
+    } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+      stats = 1;
+      stats_json = argv[i] + 8;
+    } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+      cache_dir = argv[i] + 8;
+    } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+      fprintf(stderr, "Unknown option: %s\n", argv[i]);
+      usage(argv[0]);
+      return 1;
+    } else if (!in_path) {
+      in_path = argv[i];
+    } else if (!out_path) {
+      out_path = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
     }
   }
+  if (!in_path || !out_path) {
+    usage(argv[0]);
+    return 1;
+  }
+  log_fp = stats_log_stream(stats_json);
 
-  fclose(out);
-  free(out_pixels);
+  FrameCache cache;
+  if (cache_dir && frame_cache_open(&cache, cache_dir) != 0) return 1;
 
-  printf("Done. Wrote %d pixels to %s\n", OUT_WIDTH * OUT_HEIGHT, argv[2]);
-  printf("Load in Verilog with: $readmemh(\"%s\", frame_buffer);\n", argv[2]);
-  return 0;
+  FramePool bufs;
+  frame_pool_init(&bufs);
+  Stats st;
+  stats_init(&st);
+  Converter conv;
+  memset(&conv, 0, sizeof(conv));
+  conv.bufs = &bufs;
+  conv.stats = stats ? &st : NULL;
+  conv.out_w = out_w;
+  conv.out_h = out_h;
+  conv.mode = resize_mode;
+  conv.blur = blur;
+  conv.planar = planar;
+  conv.pool = thread_pool_create(nthreads);
+
+  FrameCache *cp = cache_dir ? &cache : NULL;
+  int rc = batch ? convert_batch(&conv, cp, in_path, out_path, batch_ext)
+                 : convert_one(&conv, cp, in_path, out_path);
+  if (stats && stats_report(&st, "bmp_to_hex", stats_json) != 0) rc = 1;
+
+  converter_free(&conv);
+  thread_pool_destroy(conv.pool);
+  frame_pool_destroy(&bufs);
+  return rc;
 }
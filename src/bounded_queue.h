@@ -0,0 +1,73 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <pthread.h>
+#include <stdlib.h>
+
+// -------------------------------------------------------
+// Blocking FIFO of pointers with a fixed capacity, used to
+// connect pipeline stages. Producers block while it is
+// full, consumers while it is empty. After bq_close(),
+// bq_pop() drains what is left and then returns NULL.
+// -------------------------------------------------------
+typedef struct {
+  void **items;
+  int cap, head, count;
+  int closed;
+  pthread_mutex_t mu;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+} BoundedQueue;
+
+// Returns 0 on success, -1 on allocation failure.
+// The queue can be bq_destroy()ed either way.
+static inline int bq_init(BoundedQueue *q, int cap) {
+  pthread_mutex_init(&q->mu, NULL);
+  pthread_cond_init(&q->not_empty, NULL);
+  pthread_cond_init(&q->not_full, NULL);
+  q->cap = cap;
+  q->head = q->count = 0;
+  q->closed = 0;
+  q->items = (void **)calloc((size_t)cap, sizeof(void *));
+  return q->items ? 0 : -1;
+}
+
+static inline void bq_destroy(BoundedQueue *q) {
+  pthread_cond_destroy(&q->not_full);
+  pthread_cond_destroy(&q->not_empty);
+  pthread_mutex_destroy(&q->mu);
+  free(q->items);
+  q->items = NULL;
+}
+
+static inline void bq_push(BoundedQueue *q, void *item) {
+  pthread_mutex_lock(&q->mu);
+  while (q->count == q->cap) pthread_cond_wait(&q->not_full, &q->mu);
+  q->items[(q->head + q->count) % q->cap] = item;
+  q->count++;
+  pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->mu);
+}
+
+static inline void *bq_pop(BoundedQueue *q) {
+  pthread_mutex_lock(&q->mu);
+  while (q->count == 0 && !q->closed) pthread_cond_wait(&q->not_empty, &q->mu);
+  void *item = NULL;
+  if (q->count > 0) {
+    item = q->items[q->head];
+    q->head = (q->head + 1) % q->cap;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+  }
+  pthread_mutex_unlock(&q->mu);
+  return item;
+}
+
+static inline void bq_close(BoundedQueue *q) {
+  pthread_mutex_lock(&q->mu);
+  q->closed = 1;
+  pthread_cond_broadcast(&q->not_empty);
+  pthread_mutex_unlock(&q->mu);
+}
+
+#endif  // BOUNDED_QUEUE_H
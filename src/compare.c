@@ -0,0 +1,252 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_diff.h"
+#include "frame_io.h"
+#include "gauss_kernel.h"
+
+// -------------------------------------------------------
+// Checks simulation output against the golden model.
+//
+// Usage: compare [--size=WxH] [--golden]
+//                [--kernel=c0,..,c2R | --binomial=R |
+//                 --sigma=S [--radius=R]]
+//                [--border=pass|replicate|mirror|zero]
+//                [--list=N] [--quiet]
+//                sim ref [sim ref ...]
+// Each pair is one frame: sim is blurred.hex (or .bin /
+// .raw) from the run, ref the expected frame. With
+// --golden, ref is the blur *input* (output.hex) and the
+// expected frame is computed in process, with the same
+// kernel and border options as gs_model (--sigma taps
+// sum 256, radius ceil(2S) by default). Files are read
+// with convert's parser, so anything convert accepts works
+// here; geometry comes from the headers, --size (default
+// 320x240) covers headerless files.
+//
+// Reports the mismatch count, the first --list (default
+// 10) mismatching coordinates, the largest per-channel
+// error in RGB565 LSBs and the PSNR of the RGB888 frames
+// convert would write. Many pairs can go in one run (a
+// regression batch); buffers are reused and a summary
+// follows. Exit status: 0 all frames match, 1 some differ,
+// 2 on a read/usage error.
+// Build: cc -O2 -o compare compare.c -lm
+// -------------------------------------------------------
+
+typedef struct {
+  uint16_t *px;
+  size_t cap;
+  int w, h;
+} FrameBuf;
+
+// Reads path into b (grown as needed). w/h give the
+// geometry of headerless files. Returns 0, or -1 after
+// printing an error.
+static int load_frame(const char *path, int w, int h, FrameBuf *b) {
+  FrameFormat fmt = frame_format_from_path(path);
+  FILE *fp = fopen(path, frame_format_is_binary(fmt) ? "rb" : "r");
+  if (!fp) {
+    perror(path);
+    return -1;
+  }
+  read_frame_header(fp, fmt, &w, &h);
+  size_t n = (size_t)w * h;
+  if (n > b->cap) {
+    uint16_t *p = (uint16_t *)realloc(b->px, n * sizeof(uint16_t));
+    if (!p) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      fclose(fp);
+      return -1;
+    }
+    b->px = p;
+    b->cap = n;
+  }
+  size_t got = read_frame_pixels(fp, fmt, b->px, n);
+  fclose(fp);
+  if (got < n) {
+    fprintf(stderr, "%s: %zu of %zu pixels\n", path, got, n);
+    return -1;
+  }
+  b->w = w;
+  b->h = h;
+  return 0;
+}
+
+static void print_psnr(double psnr) {
+  if (isinf(psnr))
+    printf("inf");
+  else
+    printf("%.2f dB", psnr);
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [--size=WxH] [--golden] [--kernel=c0,.. | "
+          "--binomial=R |\n"
+          "       --sigma=S [--radius=R]]\n"
+          "       [--border=pass|replicate|mirror|zero] [--list=N] "
+          "[--quiet]\n"
+          "       sim ref [sim ref ...]\n",
+          prog);
+}
+
+int main(int argc, char *argv[]) {
+  int width = FRAME_DEFAULT_WIDTH;
+  int height = FRAME_DEFAULT_HEIGHT;
+  int golden = 0;
+  int quiet = 0;
+  long list = 10;
+  GaussKernel kernel;
+  gauss_kernel_default(&kernel);
+  GaussBorder border = GAUSS_BORDER_PASS;
+  double sigma = 0.0;
+  int radius = 0;
+  const char **pairs = (const char **)malloc((size_t)argc * sizeof(char *));
+  int npos = 0;
+  if (!pairs) return 2;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--size=", 7) == 0) {
+      if (parse_geometry(argv[i] + 7, &width, &height) != 0) {
+        fprintf(stderr, "Bad --size (expected WxH): %s\n", argv[i] + 7);
+        return 2;
+      }
+    } else if (strcmp(argv[i], "--golden") == 0) {
+      golden = 1;
+    } else if (strcmp(argv[i], "--quiet") == 0) {
+      quiet = 1;
+    } else if (strncmp(argv[i], "--list=", 7) == 0) {
+      list = atol(argv[i] + 7);
+      if (list < 0) list = 0;
+    } else if (strncmp(argv[i], "--kernel=", 9) == 0) {
+      if (gauss_kernel_parse(&kernel, argv[i] + 9) != 0) {
+        fprintf(stderr,
+                "Bad --kernel (odd tap count, sum a power of two): %s\n",
+                argv[i] + 9);
+        return 2;
+      }
+    } else if (strncmp(argv[i], "--binomial=", 11) == 0) {
+      if (gauss_kernel_binomial(&kernel, atoi(argv[i] + 11)) != 0) {
+        fprintf(stderr, "Bad --binomial radius (1..%d): %s\n",
+                GAUSS_KERNEL_MAX_SHIFT / 2, argv[i] + 11);
+        return 2;
+      }
+    } else if (strncmp(argv[i], "--sigma=", 8) == 0) {
+      sigma = atof(argv[i] + 8);
+    } else if (strncmp(argv[i], "--radius=", 9) == 0) {
+      radius = atoi(argv[i] + 9);
+    } else if (strncmp(argv[i], "--border=", 9) == 0) {
+      if (gauss_border_parse(argv[i] + 9, &border) != 0) {
+        fprintf(stderr, "Bad --border (pass|replicate|mirror|zero): %s\n",
+                argv[i] + 9);
+        return 2;
+      }
+    } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+      fprintf(stderr, "Unknown option: %s\n", argv[i]);
+      usage(argv[0]);
+      return 2;
+    } else {
+      pairs[npos++] = argv[i];
+    }
+  }
+  if (npos == 0 || npos % 2 != 0) {
+    usage(argv[0]);
+    return 2;
+  }
+  if (sigma > 0.0) {
+    if (radius <= 0) radius = (int)ceil(2.0 * sigma);
+    if (gauss_kernel_from_sigma(&kernel, radius, sigma, 8) != 0) {
+      fprintf(stderr, "Bad --sigma/--radius (radius 1..%d)\n",
+              GAUSS_KERNEL_MAX_RADIUS);
+      return 2;
+    }
+  }
+  kernel.border = border;
+
+  FrameBuf sim = {NULL, 0, 0, 0};
+  FrameBuf ref = {NULL, 0, 0, 0};
+  size_t *idx = (size_t *)malloc(((size_t)list + 1) * sizeof(size_t));
+  if (!idx) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return 2;
+  }
+
+  FrameDiff total;
+  frame_diff_init(&total);
+  int frames = 0, differ = 0, failed = 0;
+
+  for (int p = 0; p < npos; p += 2) {
+    const char *sim_path = pairs[p];
+    const char *ref_path = pairs[p + 1];
+    if (load_frame(sim_path, width, height, &sim) != 0 ||
+        load_frame(ref_path, width, height, &ref) != 0) {
+      failed++;
+      continue;
+    }
+    if (sim.w != ref.w || sim.h != ref.h) {
+      fprintf(stderr, "%s is %dx%d but %s is %dx%d\n", sim_path, sim.w,
+              sim.h, ref_path, ref.w, ref.h);
+      failed++;
+      continue;
+    }
+    if (golden && gauss_blur_rgb565_kernel(&kernel, ref.px, ref.px, ref.w,
+                                           ref.h) != 0) {
+      fprintf(stderr, "Memory allocation failed.\n");
+      failed++;
+      continue;
+    }
+
+    size_t n = (size_t)sim.w * sim.h;
+    FrameDiff d;
+    frame_diff_init(&d);
+    frame_diff_rgb565(sim.px, ref.px, n, &d, idx, (size_t)list);
+    frames++;
+
+    total.pixels += d.pixels;
+    total.mismatches += d.mismatches;
+    for (int c = 0; c < 3; c++) {
+      total.sse[c] += d.sse[c];
+      if (d.max_err[c] > total.max_err[c]) total.max_err[c] = d.max_err[c];
+    }
+
+    if (d.mismatches == 0) {
+      if (!quiet) printf("%s: OK (%zu pixels)\n", sim_path, n);
+      continue;
+    }
+    differ++;
+    printf("%s: %zu of %zu pixels differ, max error R %u G %u B %u, PSNR ",
+           sim_path, d.mismatches, n, d.max_err[0], d.max_err[1],
+           d.max_err[2]);
+    print_psnr(frame_diff_psnr(&d));
+    printf("\n");
+    size_t shown = d.mismatches < (size_t)list ? d.mismatches : (size_t)list;
+    for (size_t k = 0; k < shown; k++) {
+      size_t i = idx[k];
+      printf("  (%zu,%zu): got %04X, expected %04X\n", i % (size_t)sim.w,
+             i / (size_t)sim.w, sim.px[i], ref.px[i]);
+    }
+    if (shown < d.mismatches)
+      printf("  ... %zu more\n", d.mismatches - shown);
+  }
+
+  if (npos > 2) {
+    printf("%d frames compared, %d differ", frames, differ);
+    if (failed) printf(", %d unreadable", failed);
+    printf("; %zu of %zu pixels differ, max error R %u G %u B %u, PSNR ",
+           total.mismatches, total.pixels, total.max_err[0],
+           total.max_err[1], total.max_err[2]);
+    print_psnr(frame_diff_psnr(&total));
+    printf("\n");
+  }
+
+  free(idx);
+  free(sim.px);
+  free(ref.px);
+  free(pairs);
+  if (failed) return 2;
+  return differ ? 1 : 0;
+}
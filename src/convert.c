@@ -2,116 +2,194 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include <ctype.h>
 
-#define WIDTH  320
-#define HEIGHT 240
-#define TOTAL_PIXELS (WIDTH * HEIGHT)
+#include "frame_io.h"
+#include "frame_seq.h"
+#include "ppm.h"
+#include "stage_stats.h"
 
-static int parse_rgb565_line(const char *line, uint16_t *out)
-{
-    // Skip leading whitespace
-    while (*line && isspace((unsigned char)*line)) line++;
-
-    // Skip comment/header lines
-    if (line[0] == '/' && line[1] == '/') return 0;
+// Progress lines: stdout, or stderr when --stats=- takes it
+static FILE *log_fp;
 
-    // Trim trailing whitespace/newline by copying into a buffer
-    char buf[64];
-    size_t n = 0;
-    while (line[n] && line[n] != '\r' && line[n] != '\n' && n < sizeof(buf)-1) {
-        buf[n] = line[n];
-        n++;
+// Read a .hex/.bin/.raw frame, timed as the parse stage from
+// t0. Geometry comes from the file's header when it has one.
+// Returns 0 with a malloc'ed *out, or -1 after an error.
+static int read_frame_file(Stats *sp, double t0, const char *in_path,
+                           FrameFormat fmt, int *width, int *height,
+                           uint16_t **out)
+{
+    FILE *hex_file = fopen(in_path, frame_format_is_binary(fmt) ? "rb" : "r");
+    if (!hex_file) {
+        perror(in_path);
+        return -1;
     }
-    buf[n] = '\0';
-
-    // Empty line
-    if (n == 0) return 0;
+    read_frame_header(hex_file, fmt, width, height);
+    size_t total_pixels = (size_t)*width * *height;
 
-    // Reject unknowns like xxxx/XXXX
-    for (size_t i = 0; i < n; i++) {
-        if (buf[i] == 'x' || buf[i] == 'X') return 0;
+    uint16_t *pixels = (uint16_t *)malloc(total_pixels * sizeof(uint16_t));
+    if (!pixels) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        fclose(hex_file);
+        return -1;
     }
 
-    // Must be 1..4 hex digits only (no extra tokens)
-    for (size_t i = 0; i < n; i++) {
-        if (!isxdigit((unsigned char)buf[i])) return 0;
+    // Binary: one block read for the whole frame. Hex: chunked
+    // scanner; skips headers/xxxx/blank/bad lines safely
+    size_t written = read_frame_pixels(hex_file, fmt, pixels, total_pixels);
+    uint16_t last_valid = written > 0 ? pixels[written - 1] : 0;
+    long in_bytes = ftell(hex_file);
+    fclose(hex_file);
+    stats_add(sp, STAGE_PARSE, t0, written,
+              in_bytes > 0 ? (uint64_t)in_bytes : 0);
+
+    // If file ended early, fill remaining pixels with last valid (optional)
+    while (written < total_pixels) {
+        pixels[written++] = last_valid;
     }
-    if (n > 4) return 0;
 
-    unsigned long v = strtoul(buf, NULL, 16);
-    *out = (uint16_t)(v & 0xFFFF);
-    return 1;
+    *out = pixels;
+    return 0;
 }
 
-int main(void)
+// Decode frame frame_no of a .r5s sequence: a seek to its
+// key frame through the index, then forward. Geometry comes
+// from the container. Same contract as read_frame_file().
+static int read_seq_frame(Stats *sp, double t0, const char *in_path,
+                          long frame_no, int *width, int *height,
+                          uint16_t **out)
 {
-    FILE *hex_file = fopen("blurred.hex", "r");
-    if (!hex_file) {
-        perror("blurred.hex");
-        return 1;
+    FrameSeqReader seq;
+    if (frame_seq_open(&seq, in_path) != 0) return -1;
+    if ((uint64_t)frame_no >= seq.count) {
+        fprintf(stderr, "%s has %u frames; no frame %ld\n", in_path,
+                seq.count, frame_no);
+        frame_seq_reader_free(&seq);
+        return -1;
     }
-
-    FILE *ppm_file = fopen("output.ppm", "wb");
-    if (!ppm_file) {
-        perror("output.ppm");
-        fclose(hex_file);
-        return 1;
+    *width = seq.w;
+    *height = seq.h;
+    size_t total_pixels = (size_t)seq.w * seq.h;
+    uint16_t *pixels = (uint16_t *)malloc(total_pixels * sizeof(uint16_t));
+    if (!pixels) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        frame_seq_reader_free(&seq);
+        return -1;
     }
+    int err = frame_seq_read(&seq, (uint32_t)frame_no, pixels);
+    uint64_t in_bytes = seq.index[frame_no].bytes;
+    uint32_t count = seq.count;
+    frame_seq_reader_free(&seq);
+    if (err) {
+        fprintf(stderr, "Error: frame %ld of %s is corrupt.\n", frame_no,
+                in_path);
+        free(pixels);
+        return -1;
+    }
+    stats_add(sp, STAGE_PARSE, t0, total_pixels, in_bytes);
+    fprintf(log_fp, "Read frame %ld of %u (%dx%d)\n", frame_no, count,
+            *width, *height);
+    *out = pixels;
+    return 0;
+}
 
-    fprintf(ppm_file, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
-
-    char line[256];
-    int written = 0;
-
-    uint16_t pixel = 0;
-    uint16_t last_valid = 0;
-
-    while (written < TOTAL_PIXELS && fgets(line, sizeof(line), hex_file)) {
-        if (!parse_rgb565_line(line, &pixel)) {
-            continue; // skip headers/xxxx/blank/bad lines safely
+int main(int argc, char *argv[])
+{
+    // Usage: convert [--size=WxH] [--frame=N] [--stats[=FILE.json]]
+    //                [input.hex|.bin|.raw|.r5s] [output.ppm|.hex|.bin|.raw]
+    // Geometry comes from the input's header when it has one;
+    // --size (default 320x240) covers headerless files. A .r5s
+    // sequence gives frame N (default 0). Output is a PPM,
+    // unless it is named .hex/.bin/.raw: then the frame is
+    // written back out as-is, which expands a .r5s frame to a
+    // $readmemh file. --stats times the parse, expand and
+    // write stages.
+    const char *in_path  = "blurred.hex";
+    const char *out_path = "output.ppm";
+    int width  = FRAME_DEFAULT_WIDTH;
+    int height = FRAME_DEFAULT_HEIGHT;
+    long frame_no = -1;
+    int npos = 0;
+    int stats = 0;
+    const char *stats_json = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--size=", 7) == 0) {
+            if (parse_geometry(argv[i] + 7, &width, &height) != 0) {
+                fprintf(stderr, "Bad --size (expected WxH): %s\n", argv[i] + 7);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--frame=", 8) == 0) {
+            char *end;
+            frame_no = strtol(argv[i] + 8, &end, 10);
+            if (end == argv[i] + 8 || *end || frame_no < 0) {
+                fprintf(stderr, "Bad --frame (expected N >= 0): %s\n",
+                        argv[i] + 8);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = 1;
+        } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+            stats = 1;
+            stats_json = argv[i] + 8;
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        } else if (npos == 0) {
+            in_path = argv[i];
+            npos++;
+        } else if (npos == 1) {
+            out_path = argv[i];
+            npos++;
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--size=WxH] [--frame=N] "
+                    "[--stats[=FILE.json]] [input] [output]\n",
+                    argv[0]);
+            return 1;
         }
-
-        last_valid = pixel;
-
-        // RGB565 -> RGB888
-        uint8_t r5 = (pixel >> 11) & 0x1F;
-        uint8_t g6 = (pixel >> 5)  & 0x3F;
-        uint8_t b5 =  pixel        & 0x1F;
-
-        uint8_t r8 = (uint8_t)((r5 * 255) / 31);
-        uint8_t g8 = (uint8_t)((g6 * 255) / 63);
-        uint8_t b8 = (uint8_t)((b5 * 255) / 31);
-
-        fputc(r8, ppm_file);
-        fputc(g8, ppm_file);
-        fputc(b8, ppm_file);
-
-        written++;
     }
-
-    // If file ended early, fill remaining pixels with last valid (optional)
-    while (written < TOTAL_PIXELS) {
-        uint16_t p = last_valid;
-
-        uint8_t r5 = (p >> 11) & 0x1F;
-        uint8_t g6 = (p >> 5)  & 0x3F;
-        uint8_t b5 =  p        & 0x1F;
-
-        uint8_t r8 = (uint8_t)((r5 * 255) / 31);
-        uint8_t g8 = (uint8_t)((g6 * 255) / 63);
-        uint8_t b8 = (uint8_t)((b5 * 255) / 31);
-
-        fputc(r8, ppm_file);
-        fputc(g8, ppm_file);
-        fputc(b8, ppm_file);
-
-        written++;
+    log_fp = stats_log_stream(stats_json);
+    int seq_in = frame_seq_path(in_path);
+    if (frame_no >= 0 && !seq_in) {
+        fprintf(stderr, "--frame needs a .r5s input\n");
+        return 1;
     }
+    int frame_out = path_has_ext(out_path, ".hex") ||
+                    path_has_ext(out_path, ".bin") ||
+                    path_has_ext(out_path, ".raw");
+    FrameFormat fmt = frame_format_from_path(in_path);
+    Stats st;
+    stats_init(&st);
+    Stats *sp = stats ? &st : NULL;
+
+    uint16_t *pixels;
+    double t0 = stats_clock(sp);
+    if (seq_in) {
+        if (read_seq_frame(sp, t0, in_path, frame_no < 0 ? 0 : frame_no,
+                           &width, &height, &pixels) != 0)
+            return 1;
+    } else if (read_frame_file(sp, t0, in_path, fmt, &width, &height,
+                               &pixels) != 0) {
+        return 1;
+    }
+    size_t total_pixels = (size_t)width * height;
+
+    int err;
+    if (frame_out) {
+        t0 = stats_clock(sp);
+        uint64_t out_bytes = 0;
+        err = write_frame_path(out_path, pixels, width, height, &out_bytes);
+        if (!err)
+            stats_add(sp, STAGE_FRAME_WRITE, t0, total_pixels, out_bytes);
+    } else {
+        // RGB565 -> RGB888 PPM, one buffer and a single fwrite
+        err = write_ppm_rgb565(NULL, sp, out_path, pixels, width, height);
+    }
+    free(pixels);
+    if (err) return 1;
 
-    fclose(hex_file);
-    fclose(ppm_file);
-
-    printf("Wrote output.ppm (%d pixels)\n", TOTAL_PIXELS);
+    fprintf(log_fp, "Wrote %s (%zu pixels)\n", out_path, total_pixels);
+    st.frames = 1;
+    if (stats && stats_report(&st, "convert", stats_json) != 0) return 1;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,288 @@
+#ifndef CONVERTER_H
+#define CONVERTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_pool.h"
+#include "gauss_blur.h"
+#include "image.h"
+#include "parallel.h"
+#include "planar.h"
+#include "resize.h"
+#include "rgb565.h"
+#include "stage_stats.h"
+
+// -------------------------------------------------------
+// Resize + RGB565 pack, with state reused across frames
+//
+// RESIZE_AUTO (the default) takes the area filter when a
+// frame shrinks by more than 2x on some axis and grows on
+// neither (resize_wants_area()), and fixed-point bilinear
+// otherwise. The other modes force one engine; AREA falls
+// back to fixed bilinear for geometries it cannot take.
+// With blur set, the frame also goes through the 3x3 blur
+// (gauss_blur_rgb565(), the golden model of the core) in the
+// same pass; see converter_run_blur(). With planar set,
+// fixed bilinear runs on R/G/B planes (planar.h) instead of
+// interleaved Pixels; the output is the same. Per-frame
+// scratch is borrowed from bufs (NULL = malloc), so a
+// pooled run of same-sized frames allocates nothing after
+// the first. With stats set, the resize, pack and fused
+// stages are timed into it.
+// -------------------------------------------------------
+typedef enum {
+  RESIZE_AUTO = 0,
+  RESIZE_FIXED,
+  RESIZE_FLOAT,
+  RESIZE_AREA
+} ResizeMode;
+
+typedef struct {
+  int out_w, out_h;  // output geometry (--size, default 320x240)
+  ResizeMode mode;
+  ThreadPool *pool;
+  FramePool *bufs;  // per-frame scratch; may be NULL
+  Stats *stats;     // --stats timers; may be NULL
+  ResizeTables tables;  // for the last source geometry seen
+  int have_tables;
+  AreaTables area;  // likewise, for the area filter
+  int have_area;
+  int blur;  // converter_run() writes the blurred frame
+  int planar;  // fixed bilinear through planar images
+  PlanarImage psrc, pdst;  // kept across same-sized frames
+} Converter;
+
+static inline void converter_free(Converter *c) {
+  if (c->have_tables) resize_tables_free(&c->tables);
+  if (c->have_area) area_tables_free(&c->area);
+  planar_free(&c->psrc);
+  planar_free(&c->pdst);
+  c->have_tables = 0;
+  c->have_area = 0;
+}
+
+static inline size_t converter_pixels(const Converter *c) {
+  return (size_t)c->out_w * c->out_h;
+}
+
+// The engine converter_run() uses for a src_w x src_h
+// frame: never RESIZE_AUTO
+static inline ResizeMode converter_mode(const Converter *c, int src_w,
+                                        int src_h) {
+  switch (c->mode) {
+    case RESIZE_FLOAT:
+    case RESIZE_FIXED:
+      return c->mode;
+    case RESIZE_AREA:
+      return src_w >= c->out_w && src_h >= c->out_h ? RESIZE_AREA
+                                                    : RESIZE_FIXED;
+    default:
+      return resize_wants_area(src_w, src_h, c->out_w, c->out_h)
+                 ? RESIZE_AREA
+                 : RESIZE_FIXED;
+  }
+}
+
+static inline const char *resize_mode_name(ResizeMode m) {
+  switch (m) {
+    case RESIZE_FIXED: return "fixed-point bilinear";
+    case RESIZE_FLOAT: return "float bilinear";
+    case RESIZE_AREA: return "area (box)";
+    default: return "auto";
+  }
+}
+
+// Bilinear tables for src; rebuilt only when the geometry
+// changes. Returns 0, or -1 on allocation failure.
+static inline int converter_bilinear_tables(Converter *c, const BgrView *src) {
+  if (c->have_tables &&
+      (c->tables.src_w != src->w || c->tables.src_h != src->h)) {
+    resize_tables_free(&c->tables);
+    c->have_tables = 0;
+  }
+  if (!c->have_tables) {
+    if (resize_tables_init(&c->tables, src->w, src->h, c->out_w, c->out_h) !=
+        0)
+      return -1;
+    c->have_tables = 1;
+  }
+  return 0;
+}
+
+// Same for the area filter; -1 also when it refuses src
+static inline int converter_area_tables(Converter *c, const BgrView *src) {
+  if (c->have_area && (c->area.src_w != src->w || c->area.src_h != src->h)) {
+    area_tables_free(&c->area);
+    c->have_area = 0;
+  }
+  if (!c->have_area) {
+    if (area_tables_init(&c->area, src->w, src->h, c->out_w, c->out_h) != 0)
+      return -1;
+    c->have_area = 1;
+  }
+  return 0;
+}
+
+// The engine converter_run() actually uses for src, which
+// must need a resize: converter_mode(), with AREA falling
+// back to FIXED when converter_area_tables() refuses src
+// (blocks too large for the sums). Keeps the area tables.
+static inline ResizeMode converter_engine(Converter *c, const BgrView *src) {
+  ResizeMode mode = converter_mode(c, src->w, src->h);
+  if (mode == RESIZE_AREA && converter_area_tables(c, src) != 0)
+    mode = RESIZE_FIXED;
+  return mode;
+}
+
+// -------------------------------------------------------
+// Fused resize + pack + 3x3 blur: src → blurred frame
+// without an intermediate full frame. Resized rows are
+// packed into a 3-row RGB565 ring and their horizontal
+// blur sums into a 3-row ring of gauss_hpass() output, and
+// each output row is finished as soon as the row below it
+// exists. The working set is a few out_w-wide rows, plus
+// the resize engine's own row scratch. Bit-exact with
+// converter_run() followed by gauss_blur_rgb565(); single
+// threaded. Returns 0, or -1 on allocation failure.
+// -------------------------------------------------------
+static inline int converter_run_blur(Converter *c, const BgrView *src,
+                                     uint16_t *frame) {
+  int w = c->out_w, h = c->out_h;
+  int same = src->w == w && src->h == h;
+  ResizeMode mode = same ? RESIZE_FIXED : converter_engine(c, src);
+  if (!same && mode == RESIZE_FIXED && converter_bilinear_tables(c, src) != 0)
+    return -1;
+
+  // One resized row, 3 packed rows, 3 x 3 channels of sums, and
+  // the engine scratch (fixed: two Q8 rows; area: one row of sums)
+  size_t words = 3 * (size_t)w + gauss_ring_words(w);
+  if (!same && mode == RESIZE_FIXED) words += resize_rows_words(&c->tables);
+  uint16_t *buf =
+      (uint16_t *)frame_pool_get(c->bufs, words * sizeof(uint16_t));
+  Pixel *row = (Pixel *)frame_pool_get(c->bufs, (size_t)w * sizeof(Pixel));
+  uint32_t *acc = !same && mode == RESIZE_AREA
+                      ? (uint32_t *)frame_pool_get(
+                            c->bufs,
+                            resize_area_words(&c->area) * sizeof(uint32_t))
+                      : NULL;
+  if (!buf || !row || (!same && mode == RESIZE_AREA && !acc)) {
+    frame_pool_put(c->bufs, buf);
+    frame_pool_put(c->bufs, row);
+    frame_pool_put(c->bufs, acc);
+    return -1;
+  }
+  uint16_t *packed[3], *slot[3][3];
+  for (int r = 0; r < 3; r++) {
+    packed[r] = buf + (size_t)r * w;
+    for (int ch = 0; ch < 3; ch++)
+      slot[r][ch] = buf + 3 * (size_t)w + (size_t)(r * 3 + ch) * w;
+  }
+  uint16_t *rows = buf + 3 * (size_t)w + gauss_ring_words(w);
+  int h_row[2] = {-1, -1};
+  int interior = w >= 3 && h >= 3;
+
+  for (int y = 0; y < h; y++) {
+    uint16_t *p = packed[y % 3];
+    if (same) {
+      rgb565_pack_bgr(bgr_row(src, y), p, w);
+    } else {
+      if (mode == RESIZE_AREA)
+        resize_area_row(&c->area, src, y, row, acc);
+      else if (mode == RESIZE_FLOAT)
+        resize_bilinear_row(src, row, w, h, y);
+      else
+        resize_bilinear_fixed_row(&c->tables, src, y, row, rows, h_row);
+      rgb565_pack_rgb(row, p, (size_t)w);
+    }
+
+    // Rows 0 and h-1 (and everything, without an interior) pass
+    // through; row y-1 can be finished once row y is in the ring
+    if (!interior || y == 0 || y == h - 1)
+      memcpy(frame + (size_t)y * w, p, (size_t)w * sizeof(uint16_t));
+    if (!interior) continue;
+    gauss_hpass(p, slot[y % 3][0], slot[y % 3][1], slot[y % 3][2], w);
+    if (y < 2) continue;
+
+    int top = (y - 2) % 3, mid = (y - 1) % 3, bot = y % 3;
+    const uint16_t *const hv[3][3] = {
+        {slot[top][0], slot[top][1], slot[top][2]},
+        {slot[mid][0], slot[mid][1], slot[mid][2]},
+        {slot[bot][0], slot[bot][1], slot[bot][2]}};
+    uint16_t *o = frame + (size_t)(y - 1) * w;
+    gauss_vpass(hv, o, w);
+    // Left/right border columns pass through
+    o[0] = packed[mid][0];
+    o[w - 1] = packed[mid][w - 1];
+  }
+
+  frame_pool_put(c->bufs, buf);
+  frame_pool_put(c->bufs, row);
+  frame_pool_put(c->bufs, acc);
+  return 0;
+}
+
+// src → frame (out_w x out_h RGB565). scratch holds
+// converter_pixels() Pixels; with c->blur set the fused
+// path runs instead and scratch may be NULL. Returns 0, or
+// -1 on allocation failure.
+static inline int converter_run(Converter *c, const BgrView *src,
+                                Pixel *scratch, uint16_t *frame) {
+  uint64_t src_bytes = (uint64_t)src->w * src->h * 3;
+  uint64_t npix = converter_pixels(c);
+  double t0 = stats_clock(c->stats);
+  if (c->blur) {
+    int err = converter_run_blur(c, src, frame);
+    stats_add(c->stats, STAGE_FUSED, t0, npix, src_bytes);
+    return err;
+  }
+
+  // Already the right size: pack straight from the BMP rows
+  if (src->w == c->out_w && src->h == c->out_h) {
+    for (int y = 0; y < c->out_h; y++) {
+      rgb565_pack_bgr(bgr_row(src, y), frame + (size_t)y * c->out_w,
+                      c->out_w);
+    }
+    stats_add(c->stats, STAGE_PACK, t0, npix, src_bytes);
+    return 0;
+  }
+
+  // Coefficient tables only depend on geometry; a sequence
+  // of same-sized frames builds them once.
+  ResizeMode mode = converter_engine(c, src);
+  if (mode == RESIZE_AREA) {
+    if (resize_area_mt(c->pool, c->bufs, &c->area, src, scratch) != 0)
+      return -1;
+  } else if (mode == RESIZE_FLOAT) {
+    resize_bilinear_mt(c->pool, src, scratch, c->out_w, c->out_h);
+  } else if (c->planar) {
+    // BGR → planes, resize plane by plane, planes → RGB565
+    if (converter_bilinear_tables(c, src) != 0 ||
+        planar_reshape(&c->psrc, src->w, src->h) != 0 ||
+        planar_reshape(&c->pdst, c->out_w, c->out_h) != 0)
+      return -1;
+    planar_from_bgr(src, &c->psrc);
+    if (resize_bilinear_fixed_planar(c->bufs, &c->tables, &c->psrc,
+                                     &c->pdst) != 0)
+      return -1;
+    stats_add(c->stats, STAGE_RESIZE, t0, npix, src_bytes);
+    t0 = stats_clock(c->stats);
+    planar_pack_rgb565(&c->pdst, frame);
+    stats_add(c->stats, STAGE_PACK, t0, npix, 3 * npix);  // 3 planes
+    return 0;
+  } else {
+    if (converter_bilinear_tables(c, src) != 0) return -1;
+    if (resize_bilinear_fixed_mt(c->pool, c->bufs, &c->tables, src,
+                                 scratch) != 0)
+      return -1;
+  }
+  stats_add(c->stats, STAGE_RESIZE, t0, npix, src_bytes);
+  t0 = stats_clock(c->stats);
+  rgb565_pack_rgb(scratch, frame, converter_pixels(c));
+  stats_add(c->stats, STAGE_PACK, t0, npix, npix * sizeof(Pixel));
+  return 0;
+}
+
+#endif  // CONVERTER_H
@@ -0,0 +1,346 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "frame_io.h"
+
+// -------------------------------------------------------
+// Content-addressed frame cache (--cache=DIR)
+//
+// An output frame is a pure function of its input file and
+// the settings that shape it, so a rerun can reuse the file
+// made last time instead of recomputing it. The key is a
+// 64-bit hash (frame_hash64(), XXH64) of the input bytes
+// followed by a tool-defined config record of those
+// settings; the entry is DIR/<key, 16 hex digits><ext>, a
+// finished output file in that format.
+//
+// Entries are written under a temporary name and renamed
+// into place, so a killed run, or two runs sharing a
+// directory, never leave a torn entry behind. Nothing is
+// evicted: delete the directory to clear it. Bump
+// FRAME_CACHE_VERSION whenever a kernel change alters the
+// output, so older entries stop matching.
+// -------------------------------------------------------
+#define FRAME_CACHE_VERSION 1
+// Entry paths; the directory name leaves room for the file name
+#define FRAME_CACHE_PATH_MAX 4096
+
+// XXH64
+#define FRAME_HASH_P1 0x9E3779B185EBCA87ull
+#define FRAME_HASH_P2 0xC2B2AE3D27D4EB4Full
+#define FRAME_HASH_P3 0x165667B19E3779F9ull
+#define FRAME_HASH_P4 0x85EBCA77C2B2AE63ull
+#define FRAME_HASH_P5 0x27D4EB2F165667C5ull
+
+static inline uint64_t frame_hash_rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// Host order: keys are only compared on the machine that
+// made them (a big-endian host just gets other keys)
+static inline uint64_t frame_hash_read64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t frame_hash_read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t frame_hash_round(uint64_t acc, uint64_t in) {
+  acc += in * FRAME_HASH_P2;
+  return frame_hash_rotl(acc, 31) * FRAME_HASH_P1;
+}
+
+static inline uint64_t frame_hash_merge(uint64_t acc, uint64_t v) {
+  acc ^= frame_hash_round(0, v);
+  return acc * FRAME_HASH_P1 + FRAME_HASH_P4;
+}
+
+// Four independent lanes over 32-byte stripes, so the
+// multiplies overlap: several GB/s on one core.
+static inline uint64_t frame_hash64(const void *data, size_t len,
+                                    uint64_t seed) {
+  const uint8_t *p = (const uint8_t *)data;
+  const uint8_t *end = p + len;
+  uint64_t h;
+  if (len >= 32) {
+    uint64_t v1 = seed + FRAME_HASH_P1 + FRAME_HASH_P2;
+    uint64_t v2 = seed + FRAME_HASH_P2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - FRAME_HASH_P1;
+    const uint8_t *limit = end - 32;
+    do {
+      v1 = frame_hash_round(v1, frame_hash_read64(p));
+      v2 = frame_hash_round(v2, frame_hash_read64(p + 8));
+      v3 = frame_hash_round(v3, frame_hash_read64(p + 16));
+      v4 = frame_hash_round(v4, frame_hash_read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+    h = frame_hash_rotl(v1, 1) + frame_hash_rotl(v2, 7) +
+        frame_hash_rotl(v3, 12) + frame_hash_rotl(v4, 18);
+    h = frame_hash_merge(h, v1);
+    h = frame_hash_merge(h, v2);
+    h = frame_hash_merge(h, v3);
+    h = frame_hash_merge(h, v4);
+  } else {
+    h = seed + FRAME_HASH_P5;
+  }
+  h += (uint64_t)len;
+  for (; p + 8 <= end; p += 8) {
+    h ^= frame_hash_round(0, frame_hash_read64(p));
+    h = frame_hash_rotl(h, 27) * FRAME_HASH_P1 + FRAME_HASH_P4;
+  }
+  if (p + 4 <= end) {
+    h ^= frame_hash_read32(p) * FRAME_HASH_P1;
+    h = frame_hash_rotl(h, 23) * FRAME_HASH_P2 + FRAME_HASH_P3;
+    p += 4;
+  }
+  for (; p < end; p++) {
+    h ^= *p * FRAME_HASH_P5;
+    h = frame_hash_rotl(h, 11) * FRAME_HASH_P1;
+  }
+  h ^= h >> 33;
+  h *= FRAME_HASH_P2;
+  h ^= h >> 29;
+  h *= FRAME_HASH_P3;
+  h ^= h >> 32;
+  return h;
+}
+
+// Key of the frame made from input[0, len) under cfg. cfg is
+// a fixed-layout record, zeroed before it is filled in so
+// padding hashes the same every run.
+static inline uint64_t frame_cache_key(const void *input, size_t len,
+                                       const void *cfg, size_t cfg_len) {
+  return frame_hash64(cfg, cfg_len,
+                      frame_hash64(input, len, FRAME_CACHE_VERSION));
+}
+
+// Same, for the rest of an open file, which is rewound to
+// where it was. Returns 0, or -1 on a read or allocation
+// failure.
+static inline int frame_cache_key_file(FILE *fp, const void *cfg,
+                                       size_t cfg_len, uint64_t *key) {
+  long start = ftell(fp);
+  if (start < 0 || fseek(fp, 0, SEEK_END) != 0) return -1;
+  long end = ftell(fp);
+  if (end < start || fseek(fp, start, SEEK_SET) != 0) return -1;
+  size_t len = (size_t)(end - start);
+  void *buf = malloc(len ? len : 1);
+  if (!buf) return -1;
+  int err = fread(buf, 1, len, fp) != len || fseek(fp, start, SEEK_SET) != 0;
+  if (!err) *key = frame_cache_key(buf, len, cfg, cfg_len);
+  free(buf);
+  return err ? -1 : 0;
+}
+
+typedef struct {
+  char dir[FRAME_CACHE_PATH_MAX - 64];
+  unsigned long hits, misses;  // frame_cache_has() results
+} FrameCache;
+
+// Use dir as the cache, creating it (one level) if needed.
+// Returns 0, or -1 after printing an error.
+static inline int frame_cache_open(FrameCache *c, const char *dir) {
+  memset(c, 0, sizeof(*c));
+  size_t n = strlen(dir);
+  while (n > 1 && dir[n - 1] == '/') n--;
+  if (n == 0 || n >= sizeof(c->dir)) {
+    fprintf(stderr, "Bad --cache directory: %s\n", dir);
+    return -1;
+  }
+  memcpy(c->dir, dir, n);
+  c->dir[n] = '\0';
+  struct stat st;
+  if (mkdir(c->dir, 0777) != 0 && errno != EEXIST) {
+    perror(c->dir);
+    return -1;
+  }
+  if (stat(c->dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+    fprintf(stderr, "Error: --cache %s is not a directory.\n", c->dir);
+    return -1;
+  }
+  return 0;
+}
+
+// Entry path for key; ext includes the dot. Never truncates
+// (frame_cache_open() left room for the name).
+static inline void frame_cache_path(const FrameCache *c, uint64_t key,
+                                    const char *ext, char *p, size_t n) {
+  snprintf(p, n, "%s/%016llx%.16s", c->dir, (unsigned long long)key, ext);
+}
+
+// Whether key has an entry; counted as a hit or a miss.
+static inline int frame_cache_has(FrameCache *c, uint64_t key,
+                                  const char *ext) {
+  char path[FRAME_CACHE_PATH_MAX];
+  frame_cache_path(c, key, ext, path, sizeof(path));
+  struct stat st;
+  int hit = stat(path, &st) == 0 && S_ISREG(st.st_mode);
+  if (hit)
+    c->hits++;
+  else
+    c->misses++;
+  return hit;
+}
+
+// src → dst in 64 KiB blocks. Returns 0, or -1 after
+// printing an error; *bytes gets the size copied.
+static inline int frame_cache_copy(const char *src, const char *dst,
+                                   uint64_t *bytes) {
+  FILE *in = fopen(src, "rb");
+  if (!in) {
+    perror(src);
+    return -1;
+  }
+  FILE *out = fopen(dst, "wb");
+  if (!out) {
+    perror(dst);
+    fclose(in);
+    return -1;
+  }
+  char buf[64 * 1024];
+  uint64_t total = 0;
+  int err = 0;
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+    if (fwrite(buf, 1, n, out) != n) {
+      err = -1;
+      break;
+    }
+    total += n;
+  }
+  if (ferror(in)) err = -1;
+  fclose(in);
+  if (fclose(out) != 0) err = -1;
+  if (err) {
+    fprintf(stderr, "Error: failed copying %s to %s\n", src, dst);
+    return -1;
+  }
+  if (bytes) *bytes = total;
+  return 0;
+}
+
+// Whether files a and b hold the same bytes (0 if either
+// cannot be read)
+static inline int frame_cache_same(const char *a, const char *b) {
+  struct stat sa, sb;
+  if (stat(a, &sa) != 0 || stat(b, &sb) != 0 || sa.st_size != sb.st_size)
+    return 0;
+  FILE *fa = fopen(a, "rb");
+  FILE *fb = fopen(b, "rb");
+  int same = fa && fb;
+  char ba[32 * 1024], bb[32 * 1024];
+  while (same) {
+    size_t na = fread(ba, 1, sizeof(ba), fa);
+    size_t nb = fread(bb, 1, sizeof(bb), fb);
+    same = na == nb && memcmp(ba, bb, na) == 0;
+    if (na < sizeof(ba)) break;
+  }
+  same = same && !ferror(fa) && !ferror(fb);
+  if (fa) fclose(fa);
+  if (fb) fclose(fb);
+  return same;
+}
+
+// Make out_path a copy of key's entry. An out_path that
+// already matches (the usual case on a rerun) is left as it
+// is: comparing reads the page cache, rewriting dirties it.
+// Returns 0, or -1 after printing an error (e.g. the entry
+// went away); *bytes gets the entry size.
+static inline int frame_cache_fetch(const FrameCache *c, uint64_t key,
+                                    const char *ext, const char *out_path,
+                                    uint64_t *bytes) {
+  char path[FRAME_CACHE_PATH_MAX];
+  frame_cache_path(c, key, ext, path, sizeof(path));
+  if (frame_cache_same(path, out_path)) {
+    struct stat st;
+    if (bytes) *bytes = stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+    return 0;
+  }
+  return frame_cache_copy(path, out_path, bytes);
+}
+
+// Read a .raw entry of n words into px. Returns 0, or -1 on
+// a missing or short entry.
+static inline int frame_cache_load(const FrameCache *c, uint64_t key,
+                                   uint16_t *px, size_t n) {
+  char path[FRAME_CACHE_PATH_MAX];
+  frame_cache_path(c, key, ".raw", path, sizeof(path));
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    perror(path);
+    return -1;
+  }
+  size_t got = read_frame_pixels(fp, FRAME_FMT_RAW, px, n);
+  fclose(fp);
+  if (got != n) {
+    fprintf(stderr, "Error: cache entry %s is short.\n", path);
+    return -1;
+  }
+  return 0;
+}
+
+// Temporary name for an entry being written: hidden, unique
+// to this process (each tool stores from one thread), and
+// ending in ext so frame_format_from_path() still sees the
+// format.
+static inline void frame_cache_tmp_path(const FrameCache *c, uint64_t key,
+                                        const char *ext, char *p, size_t n) {
+  snprintf(p, n, "%s/.tmp-%ld-%016llx%.16s", c->dir, (long)getpid(),
+           (unsigned long long)key, ext);
+}
+
+static inline int frame_cache_publish(const FrameCache *c, uint64_t key,
+                                      const char *ext, const char *tmp) {
+  char path[FRAME_CACHE_PATH_MAX];
+  frame_cache_path(c, key, ext, path, sizeof(path));
+  if (rename(tmp, path) != 0) {
+    perror(path);
+    remove(tmp);
+    return -1;
+  }
+  return 0;
+}
+
+// Store the finished output file src as key's entry.
+// Returns 0, or -1 after printing an error; the output
+// itself is unaffected either way.
+static inline int frame_cache_store(const FrameCache *c, uint64_t key,
+                                    const char *ext, const char *src) {
+  char tmp[FRAME_CACHE_PATH_MAX];
+  frame_cache_tmp_path(c, key, ext, tmp, sizeof(tmp));
+  if (frame_cache_copy(src, tmp, NULL) != 0) {
+    remove(tmp);
+    return -1;
+  }
+  return frame_cache_publish(c, key, ext, tmp);
+}
+
+// Store a w x h frame as key's .raw entry (for outputs that
+// are not one file per frame, such as a .r5s sequence).
+static inline int frame_cache_store_frame(const FrameCache *c, uint64_t key,
+                                          uint16_t *px, int w, int h) {
+  char tmp[FRAME_CACHE_PATH_MAX];
+  frame_cache_tmp_path(c, key, ".raw", tmp, sizeof(tmp));
+  if (write_frame_path(tmp, px, w, h, NULL) != 0) {
+    remove(tmp);
+    return -1;
+  }
+  return frame_cache_publish(c, key, ".raw", tmp);
+}
+
+#endif  // FRAME_CACHE_H
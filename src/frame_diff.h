@@ -0,0 +1,174 @@
+#ifndef FRAME_DIFF_H
+#define FRAME_DIFF_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rgb565.h"
+
+// -------------------------------------------------------
+// Single-pass comparison of two RGB565 frames (sim output
+// against the golden model):
+//
+//  - mismatches      : pixels whose 16-bit words differ
+//  - max_err[c]      : largest |a - b| per channel, in the
+//                      channel's own LSBs (R5, G6, B5)
+//  - sse[c]          : squared error per channel after the
+//                      RGB888 expansion convert uses for
+//                      output.ppm, so psnr is what the PPMs
+//                      would show
+//
+// Identical 8-pixel blocks cost one compare; channel math
+// only runs on blocks that differ. The SSE2 path and the
+// scalar path give the same numbers.
+// -------------------------------------------------------
+typedef struct {
+  size_t pixels;
+  size_t mismatches;
+  unsigned max_err[3];
+  uint64_t sse[3];
+} FrameDiff;
+
+static inline void frame_diff_init(FrameDiff *d) { memset(d, 0, sizeof(*d)); }
+
+// Adds one pixel's channel errors to d; the caller has
+// already checked that a != b.
+static inline void frame_diff_pixel(FrameDiff *d, uint16_t a, uint16_t b) {
+  uint8_t ea[3], eb[3];
+  unsigned na[3] = {(unsigned)(a >> 11), (unsigned)((a >> 5) & 0x3F),
+                    (unsigned)(a & 0x1F)};
+  unsigned nb[3] = {(unsigned)(b >> 11), (unsigned)((b >> 5) & 0x3F),
+                    (unsigned)(b & 0x1F)};
+  from_rgb565(a, ea);
+  from_rgb565(b, eb);
+  for (int c = 0; c < 3; c++) {
+    unsigned e = na[c] > nb[c] ? na[c] - nb[c] : nb[c] - na[c];
+    if (e > d->max_err[c]) d->max_err[c] = e;
+    int e8 = (int)ea[c] - (int)eb[c];
+    d->sse[c] += (uint64_t)(e8 * e8);
+  }
+  d->mismatches++;
+}
+
+#if RGB565_X86
+// |a - b| of unsigned 16-bit lanes
+static inline __m128i frame_diff_absdiff_sse2(__m128i a, __m128i b) {
+  return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+}
+
+// 8 pixels per iteration. Squared errors go through 32-bit
+// lane accumulators (at most 2 * 255^2 per lane per block),
+// folded into d->sse often enough that they cannot wrap.
+// Returns the first index not handled.
+static inline size_t frame_diff_sse2(const uint16_t *a, const uint16_t *b,
+                                     size_t n, FrameDiff *d, size_t *idx,
+                                     size_t max_idx) {
+  const __m128i k3f = _mm_set1_epi16(0x3F);
+  const __m128i k1f = _mm_set1_epi16(0x1F);
+  const __m128i m5 = _mm_set1_epi16(RGB565_EXP5_MUL);
+  const __m128i m6 = _mm_set1_epi16(RGB565_EXP6_MUL);
+  const __m128i a6 = _mm_set1_epi16(RGB565_EXP6_ADD);
+  __m128i mx[3] = {_mm_setzero_si128(), _mm_setzero_si128(),
+                   _mm_setzero_si128()};
+  __m128i acc[3] = {_mm_setzero_si128(), _mm_setzero_si128(),
+                    _mm_setzero_si128()};
+  unsigned pending = 0;
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+    unsigned neq = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb)) &
+                   0xFFFFu;
+    if (!neq) continue;
+
+    // Two mask bits per lane; record differing lanes in order
+    size_t seen = d->mismatches;
+    for (unsigned m = neq; m; m &= m - 1, m &= m - 1) {
+      if (seen < max_idx) idx[seen] = i + (size_t)__builtin_ctz(m) / 2;
+      seen++;
+    }
+    d->mismatches = seen;
+
+    __m128i na[3] = {_mm_srli_epi16(va, 11),
+                     _mm_and_si128(_mm_srli_epi16(va, 5), k3f),
+                     _mm_and_si128(va, k1f)};
+    __m128i nb[3] = {_mm_srli_epi16(vb, 11),
+                     _mm_and_si128(_mm_srli_epi16(vb, 5), k3f),
+                     _mm_and_si128(vb, k1f)};
+    for (int c = 0; c < 3; c++) {
+      mx[c] = _mm_max_epi16(mx[c], frame_diff_absdiff_sse2(na[c], nb[c]));
+      __m128i xa, xb;
+      if (c == 1) {
+        xa = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(na[c], m6), a6),
+                            RGB565_EXP6_SHIFT);
+        xb = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(nb[c], m6), a6),
+                            RGB565_EXP6_SHIFT);
+      } else {
+        xa = _mm_srli_epi16(_mm_mullo_epi16(na[c], m5), RGB565_EXP5_SHIFT);
+        xb = _mm_srli_epi16(_mm_mullo_epi16(nb[c], m5), RGB565_EXP5_SHIFT);
+      }
+      __m128i e = frame_diff_absdiff_sse2(xa, xb);
+      acc[c] = _mm_add_epi32(acc[c], _mm_madd_epi16(e, e));
+    }
+
+    if (++pending == 8192) {
+      for (int c = 0; c < 3; c++) {
+        uint32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, acc[c]);
+        d->sse[c] += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        acc[c] = _mm_setzero_si128();
+      }
+      pending = 0;
+    }
+  }
+
+  for (int c = 0; c < 3; c++) {
+    uint32_t lanes[4];
+    uint16_t m[8];
+    _mm_storeu_si128((__m128i *)lanes, acc[c]);
+    d->sse[c] += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_storeu_si128((__m128i *)m, mx[c]);
+    for (int k = 0; k < 8; k++)
+      if (m[k] > d->max_err[c]) d->max_err[c] = m[k];
+  }
+  return i;
+}
+#endif
+
+// -------------------------------------------------------
+// Compare n pixels of a against b, accumulating into d
+// (frame_diff_init first; several calls add up, so a batch
+// can keep one running total). The first max_idx
+// mismatching indices of this call go to idx, in order.
+// -------------------------------------------------------
+static inline void frame_diff_rgb565(const uint16_t *a, const uint16_t *b,
+                                     size_t n, FrameDiff *d, size_t *idx,
+                                     size_t max_idx) {
+  size_t base = d->mismatches;
+  size_t i = 0;
+  d->pixels += n;
+  d->mismatches = 0;
+#if RGB565_X86
+  i = frame_diff_sse2(a, b, n, d, idx, max_idx);
+#endif
+  for (; i < n; i++) {
+    if (a[i] == b[i]) continue;
+    if (d->mismatches < max_idx) idx[d->mismatches] = i;
+    frame_diff_pixel(d, a[i], b[i]);
+  }
+  d->mismatches += base;
+}
+
+// PSNR over all three RGB888 channels, in dB; +inf when
+// there is no error at all.
+static inline double frame_diff_psnr(const FrameDiff *d) {
+  uint64_t sse = d->sse[0] + d->sse[1] + d->sse[2];
+  if (sse == 0 || d->pixels == 0) return INFINITY;
+  double mse = (double)sse / (3.0 * (double)d->pixels);
+  return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+#endif  // FRAME_DIFF_H
@@ -0,0 +1,536 @@
+#ifndef FRAME_IO_H
+#define FRAME_IO_H
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rgb565.h"
+
+// -------------------------------------------------------
+// RGB565 frame file formats shared by bmp_to_hex and convert
+//
+//  FRAME_FMT_HEX : one 4-digit hex word per line ($readmemh),
+//                  optionally led by a "// RGB565 WxH" line
+//  FRAME_FMT_BIN : .bin, 16-byte geometry header followed by
+//                  packed little-endian uint16 words
+//  FRAME_FMT_RAW : .raw, packed words only (no header)
+//
+// Files without a header are taken to be the default
+// 320x240 unless a tool is told otherwise (--size=WxH).
+// -------------------------------------------------------
+typedef enum { FRAME_FMT_HEX = 0, FRAME_FMT_BIN, FRAME_FMT_RAW } FrameFormat;
+
+#define FRAME_DEFAULT_WIDTH 320
+#define FRAME_DEFAULT_HEIGHT 240
+// Sanity bound on header geometry (pixels per frame)
+#define FRAME_MAX_PIXELS (1 << 28)
+
+static inline int path_has_ext(const char *path, const char *ext) {
+  size_t n = strlen(path), e = strlen(ext);
+  if (n < e) return 0;
+  for (size_t i = 0; i < e; i++) {
+    char c = path[n - e + i];
+    if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+    if (c != ext[i]) return 0;
+  }
+  return 1;
+}
+
+static inline FrameFormat frame_format_from_path(const char *path) {
+  if (path_has_ext(path, ".bin")) return FRAME_FMT_BIN;
+  if (path_has_ext(path, ".raw")) return FRAME_FMT_RAW;
+  return FRAME_FMT_HEX;
+}
+
+// The extension frame_format_from_path() maps to fmt
+static inline const char *frame_format_ext(FrameFormat fmt) {
+  return fmt == FRAME_FMT_BIN ? ".bin" : fmt == FRAME_FMT_RAW ? ".raw" : ".hex";
+}
+
+static inline int frame_format_is_binary(FrameFormat fmt) {
+  return fmt != FRAME_FMT_HEX;
+}
+
+// Parse "WxH". Returns 0 on success, -1 if malformed.
+static inline int parse_geometry(const char *s, int *w, int *h) {
+  char *end;
+  long pw = strtol(s, &end, 10);
+  if (end == s || (*end != 'x' && *end != 'X')) return -1;
+  const char *hs = end + 1;
+  long ph = strtol(hs, &end, 10);
+  if (end == hs || *end != '\0') return -1;
+  if (pw < 1 || ph < 1 || pw * ph > FRAME_MAX_PIXELS) return -1;
+  *w = (int)pw;
+  *h = (int)ph;
+  return 0;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define FRAME_IO_BIG_ENDIAN 1
+#else
+#define FRAME_IO_BIG_ENDIAN 0
+#endif
+
+static inline void swap16_inplace(uint16_t *px, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    px[i] = (uint16_t)((px[i] >> 8) | (px[i] << 8));
+}
+
+// -------------------------------------------------------
+// Geometry header
+//
+//  .hex : first line "// RGB565 WxH" ($readmemh skips it as
+//         a comment, and so does the hex scanner)
+//  .bin : "R565", u16 version (1), u16 header bytes (16),
+//         u32 width, u32 height; all little-endian
+// -------------------------------------------------------
+#define FRAME_BIN_MAGIC "R565"
+#define FRAME_BIN_VERSION 1
+#define FRAME_BIN_HEADER_BYTES 16
+
+static inline void put_le16(uint8_t *p, unsigned v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_le32(uint8_t *p, uint32_t v) {
+  put_le16(p, v & 0xFFFF);
+  put_le16(p + 2, v >> 16);
+}
+
+static inline unsigned get_le16(const uint8_t *p) {
+  return (unsigned)p[0] | ((unsigned)p[1] << 8);
+}
+
+static inline uint32_t get_le32(const uint8_t *p) {
+  return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+// Returns 0 on success, -1 on write error.
+static inline int write_frame_header(FILE *fp, FrameFormat fmt, int w,
+                                     int h) {
+  if (fmt == FRAME_FMT_HEX) {
+    return fprintf(fp, "// RGB565 %dx%d\n", w, h) < 0 ? -1 : 0;
+  }
+  if (fmt == FRAME_FMT_BIN) {
+    uint8_t hdr[FRAME_BIN_HEADER_BYTES];
+    memcpy(hdr, FRAME_BIN_MAGIC, 4);
+    put_le16(hdr + 4, FRAME_BIN_VERSION);
+    put_le16(hdr + 6, FRAME_BIN_HEADER_BYTES);
+    put_le32(hdr + 8, (uint32_t)w);
+    put_le32(hdr + 12, (uint32_t)h);
+    return fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr) ? 0 : -1;
+  }
+  return 0;
+}
+
+// -------------------------------------------------------
+// Read the geometry header of a file opened at offset 0.
+// Returns 1 and sets *w/*h if one is present, 0 if not.
+// Afterwards the stream is positioned at the pixel data
+// (hex files are rewound: the scanner skips the comment).
+// A .bin without the magic is read as headerless.
+// -------------------------------------------------------
+static inline int read_frame_header(FILE *fp, FrameFormat fmt, int *w,
+                                    int *h) {
+  int found = 0;
+  if (fmt == FRAME_FMT_HEX) {
+    char line[64];
+    int pw, ph;
+    if (fgets(line, sizeof(line), fp) &&
+        sscanf(line, " // RGB565 %dx%d", &pw, &ph) == 2 && pw > 0 && ph > 0 &&
+        (long)pw * ph <= FRAME_MAX_PIXELS) {
+      *w = pw;
+      *h = ph;
+      found = 1;
+    }
+    fseek(fp, 0, SEEK_SET);
+  } else if (fmt == FRAME_FMT_BIN) {
+    uint8_t hdr[FRAME_BIN_HEADER_BYTES];
+    size_t rd = fread(hdr, 1, sizeof(hdr), fp);
+    uint32_t pw = rd == sizeof(hdr) ? get_le32(hdr + 8) : 0;
+    uint32_t ph = rd == sizeof(hdr) ? get_le32(hdr + 12) : 0;
+    unsigned hdr_bytes = rd == sizeof(hdr) ? get_le16(hdr + 6) : 0;
+    if (rd == sizeof(hdr) && memcmp(hdr, FRAME_BIN_MAGIC, 4) == 0 &&
+        hdr_bytes >= FRAME_BIN_HEADER_BYTES && pw > 0 && ph > 0 &&
+        (uint64_t)pw * ph <= FRAME_MAX_PIXELS) {
+      *w = (int)pw;
+      *h = (int)ph;
+      found = 1;
+      fseek(fp, (long)hdr_bytes, SEEK_SET);
+    } else {
+      fseek(fp, 0, SEEK_SET);
+    }
+  }
+  return found;
+}
+
+// -------------------------------------------------------
+// Write n pixels as one little-endian block.
+// Returns 0 on success, -1 on short write.
+// -------------------------------------------------------
+static inline int write_frame_bin(FILE *fp, uint16_t *px, size_t n) {
+#if FRAME_IO_BIG_ENDIAN
+  swap16_inplace(px, n);
+  size_t wr = fwrite(px, sizeof(uint16_t), n, fp);
+  swap16_inplace(px, n);
+#else
+  size_t wr = fwrite(px, sizeof(uint16_t), n, fp);
+#endif
+  return wr == n ? 0 : -1;
+}
+
+// -------------------------------------------------------
+// Read up to n little-endian pixels in one block.
+// Returns the number of whole pixels read.
+// -------------------------------------------------------
+static inline size_t read_frame_bin(FILE *fp, uint16_t *px, size_t n) {
+  size_t rd = fread(px, sizeof(uint16_t), n, fp);
+#if FRAME_IO_BIG_ENDIAN
+  swap16_inplace(px, rd);
+#endif
+  return rd;
+}
+
+// -------------------------------------------------------
+// Parse one hex line. Returns 1 and sets *out for a valid
+// 1..4 digit word; 0 for comments, blanks, xxxx and junk.
+// -------------------------------------------------------
+static inline int parse_rgb565_line(const char *line, uint16_t *out) {
+  // Skip leading whitespace
+  while (*line && isspace((unsigned char)*line)) line++;
+
+  // Skip comment/header lines
+  if (line[0] == '/' && line[1] == '/') return 0;
+
+  // Trim trailing whitespace/newline by copying into a buffer
+  char buf[64];
+  size_t n = 0;
+  while (line[n] && line[n] != '\r' && line[n] != '\n' &&
+         n < sizeof(buf) - 1) {
+    buf[n] = line[n];
+    n++;
+  }
+  buf[n] = '\0';
+
+  // Empty line
+  if (n == 0) return 0;
+
+  // Reject unknowns like xxxx/XXXX
+  for (size_t i = 0; i < n; i++) {
+    if (buf[i] == 'x' || buf[i] == 'X') return 0;
+  }
+
+  // Must be 1..4 hex digits only (no extra tokens)
+  for (size_t i = 0; i < n; i++) {
+    if (!isxdigit((unsigned char)buf[i])) return 0;
+  }
+  if (n > 4) return 0;
+
+  unsigned long v = strtoul(buf, NULL, 16);
+  *out = (uint16_t)(v & 0xFFFF);
+  return 1;
+}
+
+// -------------------------------------------------------
+// Hex scanner
+//
+// Same acceptance rules as parse_rgb565_line(), applied to
+// a whole buffer at once instead of line by line. The
+// state survives across calls, so input can be fed in
+// arbitrary chunks (lines may straddle a chunk boundary).
+// -------------------------------------------------------
+enum {
+  HEX_LINE_START = 0,  // skipping leading whitespace
+  HEX_SLASH,           // saw one '/' at token start
+  HEX_SKIP,            // comment, or past '\r': ignore to '\n'
+  HEX_DIGITS           // inside the token
+};
+
+typedef struct {
+  int state;
+  int ndig;      // characters in the token so far
+  int bad;       // token has a non-hex character
+  unsigned val;  // value of the first 4 hex digits
+  int hold;      // HEX_SKIP reached from a token ('\r' / NUL):
+                 // emit it at '\n' if valid
+} HexScanner;
+
+static inline void hex_scanner_init(HexScanner *s) {
+  memset(s, 0, sizeof(*s));
+}
+
+static inline int hex_digit_value(unsigned char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// Ends the current line; returns 1 if it held a valid word
+static inline int hex_scanner_eol(HexScanner *s, uint16_t *out) {
+  int ok = (s->state == HEX_DIGITS || (s->state == HEX_SKIP && s->hold)) &&
+           !s->bad && s->ndig >= 1 && s->ndig <= 4;
+  if (ok) *out = (uint16_t)s->val;
+  s->state = HEX_LINE_START;
+  s->ndig = s->bad = s->hold = 0;
+  s->val = 0;
+  return ok;
+}
+
+// -------------------------------------------------------
+// Scan len bytes, storing up to max words in out. Sets
+// *used to the bytes consumed (less than len only when out
+// filled up). Returns the number of words stored.
+// -------------------------------------------------------
+static inline size_t hex_scan(HexScanner *s, const char *buf, size_t len,
+                              uint16_t *out, size_t max, size_t *used) {
+  const unsigned char *p = (const unsigned char *)buf;
+  const unsigned char *end = p + len;
+  size_t got = 0;
+
+  while (p < end && got < max) {
+    // Fast path: a whole "XXXX\n" line at line start
+    if (s->state == HEX_LINE_START && end - p >= 5 && p[4] == '\n') {
+      int d0 = hex_digit_value(p[0]), d1 = hex_digit_value(p[1]);
+      int d2 = hex_digit_value(p[2]), d3 = hex_digit_value(p[3]);
+      if ((d0 | d1 | d2 | d3) >= 0) {
+        out[got++] = (uint16_t)((d0 << 12) | (d1 << 8) | (d2 << 4) | d3);
+        p += 5;
+        continue;
+      }
+    }
+
+    unsigned char c = *p++;
+    if (c == '\n') {
+      if (hex_scanner_eol(s, &out[got])) got++;
+      continue;
+    }
+    switch (s->state) {
+      case HEX_LINE_START:
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f')
+          break;
+        if (c == '/') {
+          s->state = HEX_SLASH;
+          break;
+        }
+        if (c == '\0') {  // C string ends: empty line
+          s->state = HEX_SKIP;
+          break;
+        }
+        s->state = HEX_DIGITS;
+        goto token_char;
+      case HEX_SLASH:
+        if (c == '/') {
+          s->state = HEX_SKIP;  // comment line
+          break;
+        }
+        // A lone '/' is part of a (bad) token
+        s->state = HEX_DIGITS;
+        s->ndig = 1;
+        s->bad = 1;
+        goto token_char;
+      case HEX_SKIP:
+        break;
+      case HEX_DIGITS:
+      token_char:
+        if (c == '\r' || c == '\0') {  // token ends here
+          s->state = HEX_SKIP;
+          s->hold = 1;
+          break;
+        }
+        {
+          int d = hex_digit_value(c);
+          if (d < 0) {
+            s->bad = 1;
+          } else if (s->ndig < 4) {
+            s->val = (s->val << 4) | (unsigned)d;
+          }
+          s->ndig++;
+        }
+        break;
+    }
+  }
+  *used = (size_t)(p - (const unsigned char *)buf);
+  return got;
+}
+
+// End of input: a last line without '\n' still counts
+static inline int hex_scan_finish(HexScanner *s, uint16_t *out) {
+  return hex_scanner_eol(s, out);
+}
+
+#define FRAME_IO_CHUNK (1 << 20)
+
+// -------------------------------------------------------
+// Read up to n pixels from a hex file in large chunks,
+// skipping lines that parse_rgb565_line() rejects.
+// Returns pixels read (0, after printing an error, if the
+// chunk buffer cannot be allocated).
+// -------------------------------------------------------
+static inline size_t read_frame_hex(FILE *fp, uint16_t *px, size_t n) {
+  char *buf = (char *)malloc(FRAME_IO_CHUNK);
+  if (!buf) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return 0;
+  }
+  HexScanner s;
+  hex_scanner_init(&s);
+  size_t got = 0;
+  size_t rd;
+  while (got < n && (rd = fread(buf, 1, FRAME_IO_CHUNK, fp)) > 0) {
+    size_t used;
+    got += hex_scan(&s, buf, rd, px + got, n - got, &used);
+  }
+  if (got < n && hex_scan_finish(&s, &px[got])) got++;
+  free(buf);
+  return got;
+}
+
+// -------------------------------------------------------
+// Hex words without printf
+//
+// Each pixel is 5 bytes, "XXXX\n", formatted from a table of
+// the 256 two-digit byte spellings (or 8 pixels at a time,
+// with PSHUFB looking up the nibbles) into a block that
+// goes out with one fwrite. Byte-identical to "%04X\n".
+// -------------------------------------------------------
+#define FRAME_HEX_BLOCK_PIXELS 8192  // 40 KiB of text on the stack
+
+static const char frame_hex_pairs[513] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+static inline void format_hex_scalar(const uint16_t *px, size_t i, size_t n,
+                                     char *out) {
+  for (out += 5 * i; i < n; i++, out += 5) {
+    memcpy(out, frame_hex_pairs + 2 * (px[i] >> 8), 2);
+    memcpy(out + 2, frame_hex_pairs + 2 * (px[i] & 0xFF), 2);
+    out[4] = '\n';
+  }
+}
+
+#if RGB565_X86
+// 8 pixels → 40 bytes. Both nibbles of every byte index the
+// digit table; each word's 4 digits are put most significant
+// first, then spread over 40 bytes with '\n' after each 4.
+__attribute__((target("sse4.1"))) static inline size_t format_hex_sse41(
+    const uint16_t *px, size_t n, char *out) {
+  const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                       '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+  const __m128i lo4 = _mm_set1_epi8(0x0F);
+  // Per word: digits of the high byte, then of the low byte
+  const __m128i order =
+      _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+  // Digits of words 0-3 (a) and 4-7 (b) → output bytes 0-15,
+  // 16-31 and 32-39; -1 lanes are where the newlines go
+  const __m128i s0 =
+      _mm_setr_epi8(0, 1, 2, 3, -1, 4, 5, 6, 7, -1, 8, 9, 10, 11, -1, 12);
+  const __m128i s1a = _mm_setr_epi8(13, 14, 15, -1, -1, -1, -1, -1, -1, -1,
+                                    -1, -1, -1, -1, -1, -1);
+  const __m128i s1b =
+      _mm_setr_epi8(-1, -1, -1, -1, 0, 1, 2, 3, -1, 4, 5, 6, 7, -1, 8, 9);
+  const __m128i s2 = _mm_setr_epi8(10, 11, -1, 12, 13, 14, 15, -1, -1, -1, -1,
+                                   -1, -1, -1, -1, -1);
+  const __m128i nl0 =
+      _mm_setr_epi8(0, 0, 0, 0, '\n', 0, 0, 0, 0, '\n', 0, 0, 0, 0, '\n', 0);
+  const __m128i nl1 =
+      _mm_setr_epi8(0, 0, 0, '\n', 0, 0, 0, 0, '\n', 0, 0, 0, 0, '\n', 0, 0);
+  const __m128i nl2 =
+      _mm_setr_epi8(0, 0, '\n', 0, 0, 0, 0, '\n', 0, 0, 0, 0, 0, 0, 0, 0);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8, out += 40) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(px + i));
+    __m128i hi =
+        _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), lo4));
+    __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, lo4));
+    __m128i a = _mm_shuffle_epi8(_mm_unpacklo_epi8(hi, lo), order);
+    __m128i b = _mm_shuffle_epi8(_mm_unpackhi_epi8(hi, lo), order);
+    __m128i o0 = _mm_or_si128(_mm_shuffle_epi8(a, s0), nl0);
+    __m128i o1 = _mm_or_si128(
+        _mm_or_si128(_mm_shuffle_epi8(a, s1a), _mm_shuffle_epi8(b, s1b)), nl1);
+    __m128i o2 = _mm_or_si128(_mm_shuffle_epi8(b, s2), nl2);
+    _mm_storeu_si128((__m128i *)out, o0);
+    _mm_storeu_si128((__m128i *)(out + 16), o1);
+    _mm_storel_epi64((__m128i *)(out + 32), o2);
+  }
+  return i;
+}
+#endif
+
+// px[0, n) → 5n bytes of text at out
+static inline void format_frame_hex(const uint16_t *px, size_t n, char *out) {
+  size_t i = 0;
+#if RGB565_X86
+  if (rgb565_kernels()->level >= RGB565_SSE41)
+    i = format_hex_sse41(px, n, out);
+#endif
+  format_hex_scalar(px, i, n, out);
+}
+
+// -------------------------------------------------------
+// Write n pixels as 4-digit uppercase hex, one per line,
+// FRAME_HEX_BLOCK_PIXELS per fwrite.
+// Returns 0 on success, -1 on write error.
+// -------------------------------------------------------
+static inline int write_frame_hex(FILE *fp, const uint16_t *px, size_t n) {
+  char block[5 * FRAME_HEX_BLOCK_PIXELS];
+  for (size_t i = 0; i < n; i += FRAME_HEX_BLOCK_PIXELS) {
+    size_t m = n - i < FRAME_HEX_BLOCK_PIXELS ? n - i : FRAME_HEX_BLOCK_PIXELS;
+    format_frame_hex(px + i, m, block);
+    if (fwrite(block, 1, 5 * m, fp) != 5 * m) return -1;
+  }
+  return 0;
+}
+
+// -------------------------------------------------------
+// Pixel data in whichever format the file uses
+// -------------------------------------------------------
+static inline size_t read_frame_pixels(FILE *fp, FrameFormat fmt,
+                                       uint16_t *px, size_t n) {
+  return frame_format_is_binary(fmt) ? read_frame_bin(fp, px, n)
+                                     : read_frame_hex(fp, px, n);
+}
+
+static inline int write_frame_pixels(FILE *fp, FrameFormat fmt, uint16_t *px,
+                                     size_t n) {
+  return frame_format_is_binary(fmt) ? write_frame_bin(fp, px, n)
+                                     : write_frame_hex(fp, px, n);
+}
+
+// -------------------------------------------------------
+// A whole frame file (geometry header + pixels) in the
+// format path's extension names. *bytes, if given, gets
+// the file size. Returns 0, or -1 after printing an error.
+// -------------------------------------------------------
+static inline int write_frame_path(const char *path, uint16_t *px, int w,
+                                   int h, uint64_t *bytes) {
+  FrameFormat fmt = frame_format_from_path(path);
+  FILE *out = fopen(path, frame_format_is_binary(fmt) ? "wb" : "w");
+  if (!out) {
+    perror("Cannot open output file");
+    return -1;
+  }
+  int write_err = write_frame_header(out, fmt, w, h);
+  if (!write_err) write_err = write_frame_pixels(out, fmt, px, (size_t)w * h);
+  long len = ftell(out);
+  if (fclose(out) != 0) write_err = -1;
+  if (write_err) {
+    fprintf(stderr, "Error: failed writing %s\n", path);
+    return -1;
+  }
+  if (bytes) *bytes = len > 0 ? (uint64_t)len : 0;
+  return 0;
+}
+
+#endif  // FRAME_IO_H
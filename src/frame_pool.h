@@ -0,0 +1,135 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+// -------------------------------------------------------
+// Frame-buffer pool
+//
+// Frames, resize scratch and PPM images are borrowed with
+// frame_pool_get() and handed back with frame_pool_put()
+// instead of being malloc'ed and freed per frame. A
+// returned buffer is kept and lent out again to the next
+// request of the same size, so a run of same-geometry
+// frames allocates (and page-faults) only for the first
+// one. Sizes from FRAME_POOL_HUGE_BYTES up are backed by
+// 2 MiB-aligned blocks offered to the kernel as huge pages;
+// smaller ones are cache-line aligned.
+//
+// A NULL pool is valid everywhere and means plain
+// malloc/free, so one-shot tools can pass NULL. The pool is
+// thread-safe.
+// -------------------------------------------------------
+#define FRAME_POOL_ENTRIES 32
+#define FRAME_POOL_ALIGN 64
+#define FRAME_POOL_HUGE_BYTES ((size_t)2 << 20)
+
+typedef struct {
+  void *buf;
+  size_t bytes;  // size class: the rounded request size
+  int busy;
+} FramePoolEntry;
+
+typedef struct {
+  pthread_mutex_t mu;
+  FramePoolEntry e[FRAME_POOL_ENTRIES];
+  int n;
+  size_t allocs;  // backing allocations made so far
+} FramePool;
+
+static inline void frame_pool_init(FramePool *p) {
+  memset(p, 0, sizeof(*p));
+  pthread_mutex_init(&p->mu, NULL);
+}
+
+// Every buffer must have been put back
+static inline void frame_pool_destroy(FramePool *p) {
+  for (int i = 0; i < p->n; i++) free(p->e[i].buf);
+  pthread_mutex_destroy(&p->mu);
+  memset(p, 0, sizeof(*p));
+}
+
+static inline size_t frame_pool_class(size_t bytes) {
+  size_t a = bytes >= FRAME_POOL_HUGE_BYTES ? FRAME_POOL_HUGE_BYTES
+                                            : FRAME_POOL_ALIGN;
+  return (bytes + a - 1) & ~(a - 1);
+}
+
+static inline void *frame_pool_alloc(size_t bytes) {
+  int huge = bytes >= FRAME_POOL_HUGE_BYTES;
+  void *buf = aligned_alloc(huge ? FRAME_POOL_HUGE_BYTES : FRAME_POOL_ALIGN,
+                            bytes);
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+  if (buf && huge) madvise(buf, bytes, MADV_HUGEPAGE);
+#endif
+  return buf;
+}
+
+// A buffer of at least bytes bytes, or NULL on allocation
+// failure. Contents are undefined.
+static inline void *frame_pool_get(FramePool *p, size_t bytes) {
+  if (!p) return malloc(bytes ? bytes : 1);
+  size_t cls = frame_pool_class(bytes ? bytes : 1);
+  pthread_mutex_lock(&p->mu);
+  int slot = -1, idle = -1;
+  for (int i = 0; i < p->n; i++) {
+    if (p->e[i].busy) continue;
+    if (p->e[i].bytes == cls) {
+      slot = i;
+      break;
+    }
+    idle = i;
+  }
+  if (slot < 0) {
+    // New size: take a fresh entry, else evict an idle one of
+    // another size; with every entry lent out the buffer is
+    // untracked and frame_pool_put() frees it.
+    if (p->n < FRAME_POOL_ENTRIES) {
+      slot = p->n++;
+    } else if (idle >= 0) {
+      slot = idle;
+      free(p->e[slot].buf);
+    }
+    void *buf = frame_pool_alloc(cls);
+    p->allocs++;
+    if (slot < 0 || !buf) {
+      if (slot >= 0) p->e[slot] = p->e[--p->n];
+      pthread_mutex_unlock(&p->mu);
+      return buf;
+    }
+    p->e[slot].buf = buf;
+    p->e[slot].bytes = cls;
+  }
+  p->e[slot].busy = 1;
+  void *buf = p->e[slot].buf;
+  pthread_mutex_unlock(&p->mu);
+  return buf;
+}
+
+// Return a buffer from frame_pool_get(); NULL is ignored
+static inline void frame_pool_put(FramePool *p, void *buf) {
+  if (!buf) return;
+  if (!p) {
+    free(buf);
+    return;
+  }
+  pthread_mutex_lock(&p->mu);
+  for (int i = 0; i < p->n; i++) {
+    if (p->e[i].buf == buf) {
+      p->e[i].busy = 0;
+      pthread_mutex_unlock(&p->mu);
+      return;
+    }
+  }
+  pthread_mutex_unlock(&p->mu);
+  free(buf);
+}
+
+#endif  // FRAME_POOL_H
@@ -0,0 +1,432 @@
+#ifndef FRAME_SEQ_H
+#define FRAME_SEQ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_io.h"
+
+// -------------------------------------------------------
+// .r5s: a compact container for a sequence of same-sized
+// RGB565 frames, written by bmp_to_hex and read by convert
+// (which also expands frames back to .hex for $readmemh).
+//
+//  header (32 bytes, little-endian):
+//    "R5SQ", u16 version (1), u16 header bytes (32),
+//    u32 width, u32 height, u32 frame count,
+//    u32 key interval, u64 index offset
+//  frame records, back to back
+//  index: per frame u64 offset, u32 bytes, u32 flags
+//         (FRAME_SEQ_KEY), written on close
+//
+// A record is a token stream covering the frame's words in
+// raster order. Each token is one byte, op in bits 7:6 and
+// length - 1 in bits 5:0:
+//
+//  SEQ_COPY (0) : words equal to the previous frame's
+//  SEQ_RUN  (1) : one u16 word, repeated
+//  SEQ_LIT  (2) : that many u16 words follow
+//
+// COPY and RUN store length - 1 = 63 as "64 or more", with
+// the rest (length - 64) following as a LEB128 varint; LIT
+// tokens hold at most 64 words. Key frames (every key
+// interval-th frame, and the first) use no COPY tokens, so
+// any frame decodes from the nearest key frame before it;
+// the index makes finding that a seek.
+// -------------------------------------------------------
+#define FRAME_SEQ_MAGIC "R5SQ"
+#define FRAME_SEQ_VERSION 1
+#define FRAME_SEQ_HEADER_BYTES 32
+#define FRAME_SEQ_INDEX_ENTRY_BYTES 16
+#define FRAME_SEQ_KEY 1u
+#define FRAME_SEQ_KEY_INTERVAL 30
+
+enum { SEQ_COPY = 0, SEQ_RUN = 1, SEQ_LIT = 2 };
+
+#define SEQ_LIT_MAX 64
+// Shortest RUN worth a token (a literal word costs 2 bytes)
+#define SEQ_RUN_MIN 3
+
+static inline int frame_seq_path(const char *path) {
+  return path_has_ext(path, ".r5s");
+}
+
+static inline void put_le64(uint8_t *p, uint64_t v) {
+  put_le32(p, (uint32_t)v);
+  put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline uint64_t get_le64(const uint8_t *p) {
+  return get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
+
+// Largest record for n words
+static inline size_t frame_seq_bound(size_t n) {
+  return 2 * n + (n + SEQ_LIT_MAX - 1) / SEQ_LIT_MAX + 16;
+}
+
+// -------------------------------------------------------
+// Codec
+// -------------------------------------------------------
+// LIT tokens always fit in one byte (len <= SEQ_LIT_MAX)
+static inline uint8_t *seq_put_token(uint8_t *o, int op, size_t len) {
+  if (len < 64 || op == SEQ_LIT) {
+    *o++ = (uint8_t)((op << 6) | (len - 1));
+    return o;
+  }
+  *o++ = (uint8_t)((op << 6) | 63);
+  for (len -= 64; len >= 0x80; len >>= 7) *o++ = (uint8_t)(len | 0x80);
+  *o++ = (uint8_t)len;
+  return o;
+}
+
+static inline uint8_t *seq_put_words(uint8_t *o, const uint16_t *px,
+                                     size_t n) {
+#if FRAME_IO_BIG_ENDIAN
+  for (size_t i = 0; i < n; i++) put_le16(o + 2 * i, px[i]);
+#else
+  memcpy(o, px, n * sizeof(uint16_t));
+#endif
+  return o + 2 * n;
+}
+
+static inline uint8_t *seq_put_literal(uint8_t *o, const uint16_t *px,
+                                       size_t n) {
+  while (n > 0) {
+    size_t m = n < SEQ_LIT_MAX ? n : SEQ_LIT_MAX;
+    o = seq_put_token(o, SEQ_LIT, m);
+    o = seq_put_words(o, px, m);
+    px += m;
+    n -= m;
+  }
+  return o;
+}
+
+// -------------------------------------------------------
+// Encode px[0, n) against ref (the previous frame), or as a
+// key frame when ref is NULL. out must hold
+// frame_seq_bound(n) bytes. Returns the record size.
+// -------------------------------------------------------
+static inline size_t frame_seq_encode(const uint16_t *px, const uint16_t *ref,
+                                      size_t n, uint8_t *out) {
+  uint8_t *o = out;
+  size_t lit = 0;  // literal words pending before i
+  size_t i = 0;
+  while (i < n) {
+    size_t c = 0;
+    if (ref)
+      while (i + c < n && px[i + c] == ref[i + c]) c++;
+    size_t r = 1;
+    if (c < 2)
+      while (i + r < n && px[i + r] == px[i]) r++;
+    if (c >= 2 || r >= SEQ_RUN_MIN) {
+      o = seq_put_literal(o, px + i - lit, lit);
+      lit = 0;
+      if (c >= 2) {
+        o = seq_put_token(o, SEQ_COPY, c);
+        i += c;
+      } else {
+        o = seq_put_token(o, SEQ_RUN, r);
+        o = seq_put_words(o, px + i, 1);
+        i += r;
+      }
+      continue;
+    }
+    lit++;
+    i++;
+  }
+  o = seq_put_literal(o, px + i - lit, lit);
+  return (size_t)(o - out);
+}
+
+// -------------------------------------------------------
+// Decode a record into out[0, n). COPY keeps what out
+// already holds, so out must hold the previous frame for a
+// delta record (decoding runs in place, frame after
+// frame). Returns 0, or -1 if the record is malformed or
+// does not cover exactly n words.
+// -------------------------------------------------------
+static inline int frame_seq_decode(const uint8_t *in, size_t len, int key,
+                                   uint16_t *out, size_t n) {
+  const uint8_t *end = in + len;
+  size_t i = 0;
+  while (in < end) {
+    int op = *in >> 6;
+    size_t cnt = (size_t)(*in++ & 63) + 1;
+    if (cnt == 64 && op != SEQ_LIT) {
+      size_t extra = 0;
+      int shift = 0;
+      for (;;) {
+        if (in == end || shift > 28) return -1;
+        uint8_t b = *in++;
+        extra |= (size_t)(b & 0x7F) << shift;
+        shift += 7;
+        if (!(b & 0x80)) break;
+      }
+      cnt += extra;
+    }
+    if (cnt > n - i) return -1;
+    if (op == SEQ_COPY) {
+      if (key) return -1;
+    } else if (op == SEQ_RUN) {
+      if (end - in < 2) return -1;
+      uint16_t v = (uint16_t)get_le16(in);
+      in += 2;
+      for (size_t k = 0; k < cnt; k++) out[i + k] = v;
+    } else if (op == SEQ_LIT) {
+      if ((size_t)(end - in) < 2 * cnt) return -1;
+#if FRAME_IO_BIG_ENDIAN
+      for (size_t k = 0; k < cnt; k++)
+        out[i + k] = (uint16_t)get_le16(in + 2 * k);
+#else
+      memcpy(out + i, in, cnt * sizeof(uint16_t));
+#endif
+      in += 2 * cnt;
+    } else {
+      return -1;
+    }
+    i += cnt;
+  }
+  return i == n ? 0 : -1;
+}
+
+// -------------------------------------------------------
+// Writer: frames are appended as they come; the index and
+// the final header go out in frame_seq_finish(), so the
+// output must be seekable.
+// -------------------------------------------------------
+typedef struct {
+  uint64_t offset;
+  uint32_t bytes;
+  uint32_t flags;
+} FrameSeqEntry;
+
+typedef struct {
+  FILE *fp;
+  int w, h;
+  int key_interval;
+  FrameSeqEntry *index;
+  uint32_t count, cap;
+  uint64_t pos;
+  uint16_t *prev;  // last frame appended
+  uint8_t *rec;    // frame_seq_bound() bytes
+  uint64_t raw_bytes, coded_bytes;
+} FrameSeqWriter;
+
+static inline void frame_seq_writer_free(FrameSeqWriter *s) {
+  if (s->fp) fclose(s->fp);
+  free(s->index);
+  free(s->prev);
+  free(s->rec);
+  memset(s, 0, sizeof(*s));
+}
+
+static inline int frame_seq_put_header(FrameSeqWriter *s,
+                                       uint64_t index_offset) {
+  uint8_t hdr[FRAME_SEQ_HEADER_BYTES];
+  memcpy(hdr, FRAME_SEQ_MAGIC, 4);
+  put_le16(hdr + 4, FRAME_SEQ_VERSION);
+  put_le16(hdr + 6, FRAME_SEQ_HEADER_BYTES);
+  put_le32(hdr + 8, (uint32_t)s->w);
+  put_le32(hdr + 12, (uint32_t)s->h);
+  put_le32(hdr + 16, s->count);
+  put_le32(hdr + 20, (uint32_t)s->key_interval);
+  put_le64(hdr + 24, index_offset);
+  return fwrite(hdr, 1, sizeof(hdr), s->fp) == sizeof(hdr) ? 0 : -1;
+}
+
+// Returns 0, or -1 after printing an error.
+static inline int frame_seq_create(FrameSeqWriter *s, const char *path, int w,
+                                   int h) {
+  memset(s, 0, sizeof(*s));
+  s->w = w;
+  s->h = h;
+  s->key_interval = FRAME_SEQ_KEY_INTERVAL;
+  size_t n = (size_t)w * h;
+  s->prev = (uint16_t *)malloc(n * sizeof(uint16_t));
+  s->rec = (uint8_t *)malloc(frame_seq_bound(n));
+  if (!s->prev || !s->rec) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    frame_seq_writer_free(s);
+    return -1;
+  }
+  s->fp = fopen(path, "wb");
+  if (!s->fp) {
+    perror(path);
+    frame_seq_writer_free(s);
+    return -1;
+  }
+  // Placeholder until frame_seq_finish() knows the index offset
+  if (frame_seq_put_header(s, 0) != 0) {
+    fprintf(stderr, "Error: failed writing %s\n", path);
+    frame_seq_writer_free(s);
+    return -1;
+  }
+  s->pos = FRAME_SEQ_HEADER_BYTES;
+  return 0;
+}
+
+// Append one w x h frame. Returns 0, or -1 on write or
+// allocation failure.
+static inline int frame_seq_append(FrameSeqWriter *s, const uint16_t *px) {
+  if (s->count == s->cap) {
+    uint32_t cap = s->cap ? 2 * s->cap : 64;
+    FrameSeqEntry *index = (FrameSeqEntry *)realloc(
+        s->index, (size_t)cap * sizeof(FrameSeqEntry));
+    if (!index) return -1;
+    s->index = index;
+    s->cap = cap;
+  }
+  size_t n = (size_t)s->w * s->h;
+  int key = s->count % (uint32_t)s->key_interval == 0;
+  size_t len = frame_seq_encode(px, key ? NULL : s->prev, n, s->rec);
+  if (fwrite(s->rec, 1, len, s->fp) != len) return -1;
+  FrameSeqEntry *e = &s->index[s->count++];
+  e->offset = s->pos;
+  e->bytes = (uint32_t)len;
+  e->flags = key ? FRAME_SEQ_KEY : 0;
+  s->pos += len;
+  s->raw_bytes += 2 * n;
+  s->coded_bytes += len;
+  memcpy(s->prev, px, n * sizeof(uint16_t));
+  return 0;
+}
+
+// Write the index, patch the header and close. Returns 0,
+// or -1 on write error; s is released either way.
+static inline int frame_seq_finish(FrameSeqWriter *s) {
+  int err = 0;
+  uint8_t ent[FRAME_SEQ_INDEX_ENTRY_BYTES];
+  for (uint32_t i = 0; i < s->count && !err; i++) {
+    put_le64(ent, s->index[i].offset);
+    put_le32(ent + 8, s->index[i].bytes);
+    put_le32(ent + 12, s->index[i].flags);
+    err = fwrite(ent, 1, sizeof(ent), s->fp) != sizeof(ent);
+  }
+  if (!err) err = fseek(s->fp, 0, SEEK_SET) != 0;
+  if (!err) err = frame_seq_put_header(s, s->pos) != 0;
+  FILE *fp = s->fp;
+  s->fp = NULL;
+  if (fclose(fp) != 0) err = 1;
+  frame_seq_writer_free(s);
+  return err ? -1 : 0;
+}
+
+// -------------------------------------------------------
+// Reader: random access by frame number through the index
+// -------------------------------------------------------
+typedef struct {
+  FILE *fp;
+  int w, h;
+  uint32_t count;
+  FrameSeqEntry *index;
+  uint8_t *rec;
+  size_t rec_cap;
+  uint16_t *cur;  // decoded frame cur_frame (-1: none)
+  long cur_frame;
+} FrameSeqReader;
+
+static inline void frame_seq_reader_free(FrameSeqReader *r) {
+  if (r->fp) fclose(r->fp);
+  free(r->index);
+  free(r->rec);
+  free(r->cur);
+  memset(r, 0, sizeof(*r));
+}
+
+// Returns 0, or -1 after printing an error.
+static inline int frame_seq_open(FrameSeqReader *r, const char *path) {
+  memset(r, 0, sizeof(*r));
+  r->cur_frame = -1;
+  r->fp = fopen(path, "rb");
+  if (!r->fp) {
+    perror(path);
+    return -1;
+  }
+  uint8_t hdr[FRAME_SEQ_HEADER_BYTES];
+  int bad = fread(hdr, 1, sizeof(hdr), r->fp) != sizeof(hdr) ||
+            memcmp(hdr, FRAME_SEQ_MAGIC, 4) != 0 ||
+            get_le16(hdr + 4) != FRAME_SEQ_VERSION;
+  uint64_t index_offset = bad ? 0 : get_le64(hdr + 24);
+  if (!bad) {
+    r->w = (int)get_le32(hdr + 8);
+    r->h = (int)get_le32(hdr + 12);
+    r->count = get_le32(hdr + 16);
+    bad = get_le32(hdr + 8) == 0 || get_le32(hdr + 12) == 0 ||
+          (uint64_t)get_le32(hdr + 8) * get_le32(hdr + 12) >
+              FRAME_MAX_PIXELS ||
+          index_offset < FRAME_SEQ_HEADER_BYTES;
+  }
+  // The index must fit between index_offset and the end
+  long file_len = -1;
+  if (!bad && fseek(r->fp, 0, SEEK_END) == 0) file_len = ftell(r->fp);
+  bad = bad || file_len < 0 ||
+        index_offset + (uint64_t)r->count * FRAME_SEQ_INDEX_ENTRY_BYTES >
+            (uint64_t)file_len;
+  if (!bad && r->count > 0) {
+    r->index =
+        (FrameSeqEntry *)malloc((size_t)r->count * sizeof(FrameSeqEntry));
+    bad = !r->index || fseek(r->fp, (long)index_offset, SEEK_SET) != 0;
+    uint8_t ent[FRAME_SEQ_INDEX_ENTRY_BYTES];
+    size_t bound = frame_seq_bound((size_t)r->w * r->h);
+    for (uint32_t i = 0; i < r->count && !bad; i++) {
+      bad = fread(ent, 1, sizeof(ent), r->fp) != sizeof(ent);
+      r->index[i].offset = get_le64(ent);
+      r->index[i].bytes = get_le32(ent + 8);
+      r->index[i].flags = get_le32(ent + 12);
+      bad = bad || r->index[i].bytes > bound ||
+            r->index[i].offset < FRAME_SEQ_HEADER_BYTES ||
+            r->index[i].offset + r->index[i].bytes > index_offset;
+      if (r->index[i].bytes > r->rec_cap) r->rec_cap = r->index[i].bytes;
+    }
+    // The first frame must be a key frame for any to decode
+    bad = bad || !(r->index[0].flags & FRAME_SEQ_KEY);
+  }
+  if (bad) {
+    fprintf(stderr, "Error: %s is not a valid .r5s sequence.\n", path);
+    frame_seq_reader_free(r);
+    return -1;
+  }
+  r->rec = (uint8_t *)malloc(r->rec_cap ? r->rec_cap : 1);
+  r->cur = (uint16_t *)malloc((size_t)r->w * r->h * sizeof(uint16_t));
+  if (!r->rec || !r->cur) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    frame_seq_reader_free(r);
+    return -1;
+  }
+  return 0;
+}
+
+// -------------------------------------------------------
+// Decode frame k into out (w x h words). Decoding starts
+// at the last key frame at or before k, or carries on from
+// the frame decoded last when that is on the way (reading
+// frames in order decodes each one once). Returns 0, or -1
+// on a read error or a malformed record.
+// -------------------------------------------------------
+static inline int frame_seq_read(FrameSeqReader *r, uint32_t k,
+                                 uint16_t *out) {
+  if (k >= r->count) return -1;
+  uint32_t start = k;
+  while (!(r->index[start].flags & FRAME_SEQ_KEY)) start--;
+  if (r->cur_frame >= (long)start && r->cur_frame <= (long)k)
+    start = (uint32_t)r->cur_frame + 1;
+  size_t n = (size_t)r->w * r->h;
+  for (uint32_t i = start; i <= k; i++) {
+    const FrameSeqEntry *e = &r->index[i];
+    r->cur_frame = -1;
+    if (fseek(r->fp, (long)e->offset, SEEK_SET) != 0 ||
+        fread(r->rec, 1, e->bytes, r->fp) != e->bytes ||
+        frame_seq_decode(r->rec, e->bytes, (e->flags & FRAME_SEQ_KEY) != 0,
+                         r->cur, n) != 0)
+      return -1;
+    r->cur_frame = (long)i;
+  }
+  memcpy(out, r->cur, n * sizeof(uint16_t));
+  return 0;
+}
+
+#endif  // FRAME_SEQ_H
@@ -0,0 +1,323 @@
+#ifndef GAUSS_BLUR_H
+#define GAUSS_BLUR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GAUSS_X86 1
+#include <immintrin.h>
+#else
+#define GAUSS_X86 0
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GAUSS_NEON 1
+#include <arm_neon.h>
+#else
+#define GAUSS_NEON 0
+#endif
+
+// -------------------------------------------------------
+// Software golden model of gaussian_blur_rgb565_320x240
+// (src/gs.v), bit-exact on packed RGB565:
+//
+//  - border rows/columns are copied through unchanged
+//  - every interior pixel gets, per channel,
+//        1 2 1
+//        2 4 2   >> 4   (truncating, like sumX[9:4])
+//        1 2 1
+//
+// The kernel is run separably, the way the RTL streams
+// rows: each input row is reduced once to horizontal
+// 1-2-1 sums per channel and kept in a 3-row ring of line
+// buffers; the vertical 1-2-1 then combines the ring into
+// one output row. The sum is the same integer as the 3x3
+// expression, so the result is exact. Row kernels are
+// vectorized (SSE2 / AVX2 / NEON) with scalar tails.
+// -------------------------------------------------------
+
+// Horizontal 1-2-1 for columns 1..w-2 of one RGB565 row
+static inline void gauss_hpass_scalar(const uint16_t *in, uint16_t *hr,
+                                      uint16_t *hg, uint16_t *hb, int x0,
+                                      int x1) {
+  for (int x = x0; x < x1; x++) {
+    uint16_t a = in[x - 1], b = in[x], c = in[x + 1];
+    hr[x] = (uint16_t)((a >> 11) + 2 * (b >> 11) + (c >> 11));
+    hg[x] = (uint16_t)(((a >> 5) & 0x3F) + 2 * ((b >> 5) & 0x3F) +
+                       ((c >> 5) & 0x3F));
+    hb[x] = (uint16_t)((a & 0x1F) + 2 * (b & 0x1F) + (c & 0x1F));
+  }
+}
+
+// Vertical 1-2-1 of three ring rows, >>4, repacked to RGB565
+static inline void gauss_vpass_scalar(const uint16_t *const h[3][3],
+                                      uint16_t *out, int x0, int x1) {
+  for (int x = x0; x < x1; x++) {
+    unsigned r = (h[0][0][x] + 2u * h[1][0][x] + h[2][0][x]) >> 4;
+    unsigned g = (h[0][1][x] + 2u * h[1][1][x] + h[2][1][x]) >> 4;
+    unsigned b = (h[0][2][x] + 2u * h[1][2][x] + h[2][2][x]) >> 4;
+    out[x] = (uint16_t)((r << 11) | (g << 5) | b);
+  }
+}
+
+#if GAUSS_X86
+// ---- SSE2 (x86-64 baseline): 8 pixels per iteration ----
+static inline int gauss_hpass_sse2(const uint16_t *in, uint16_t *hr,
+                                   uint16_t *hg, uint16_t *hb, int x0,
+                                   int x1) {
+  const __m128i k3f = _mm_set1_epi16(0x3F);
+  const __m128i k1f = _mm_set1_epi16(0x1F);
+  int x = x0;
+  for (; x + 8 <= x1; x += 8) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(in + x - 1));
+    __m128i b = _mm_loadu_si128((const __m128i *)(in + x));
+    __m128i c = _mm_loadu_si128((const __m128i *)(in + x + 1));
+    __m128i r = _mm_add_epi16(
+        _mm_add_epi16(_mm_srli_epi16(a, 11), _mm_srli_epi16(c, 11)),
+        _mm_slli_epi16(_mm_srli_epi16(b, 11), 1));
+    __m128i g = _mm_add_epi16(
+        _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(a, 5), k3f),
+                      _mm_and_si128(_mm_srli_epi16(c, 5), k3f)),
+        _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(b, 5), k3f), 1));
+    __m128i bl = _mm_add_epi16(
+        _mm_add_epi16(_mm_and_si128(a, k1f), _mm_and_si128(c, k1f)),
+        _mm_slli_epi16(_mm_and_si128(b, k1f), 1));
+    _mm_storeu_si128((__m128i *)(hr + x), r);
+    _mm_storeu_si128((__m128i *)(hg + x), g);
+    _mm_storeu_si128((__m128i *)(hb + x), bl);
+  }
+  return x;
+}
+
+static inline __m128i gauss_v121_sse2(const uint16_t *const h[3][3], int ch,
+                                      int x) {
+  __m128i t = _mm_loadu_si128((const __m128i *)(h[0][ch] + x));
+  __m128i m = _mm_loadu_si128((const __m128i *)(h[1][ch] + x));
+  __m128i b = _mm_loadu_si128((const __m128i *)(h[2][ch] + x));
+  return _mm_srli_epi16(
+      _mm_add_epi16(_mm_add_epi16(t, b), _mm_slli_epi16(m, 1)), 4);
+}
+
+static inline int gauss_vpass_sse2(const uint16_t *const h[3][3],
+                                   uint16_t *out, int x0, int x1) {
+  int x = x0;
+  for (; x + 8 <= x1; x += 8) {
+    __m128i r = gauss_v121_sse2(h, 0, x);
+    __m128i g = gauss_v121_sse2(h, 1, x);
+    __m128i b = gauss_v121_sse2(h, 2, x);
+    __m128i px = _mm_or_si128(
+        _mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+    _mm_storeu_si128((__m128i *)(out + x), px);
+  }
+  return x;
+}
+
+// ---- AVX2: 16 pixels per iteration ----
+__attribute__((target("avx2"))) static inline int gauss_hpass_avx2(
+    const uint16_t *in, uint16_t *hr, uint16_t *hg, uint16_t *hb, int x0,
+    int x1) {
+  const __m256i k3f = _mm256_set1_epi16(0x3F);
+  const __m256i k1f = _mm256_set1_epi16(0x1F);
+  int x = x0;
+  for (; x + 16 <= x1; x += 16) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(in + x - 1));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(in + x));
+    __m256i c = _mm256_loadu_si256((const __m256i *)(in + x + 1));
+    __m256i r = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_srli_epi16(a, 11), _mm256_srli_epi16(c, 11)),
+        _mm256_slli_epi16(_mm256_srli_epi16(b, 11), 1));
+    __m256i g = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_and_si256(_mm256_srli_epi16(a, 5), k3f),
+                         _mm256_and_si256(_mm256_srli_epi16(c, 5), k3f)),
+        _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(b, 5), k3f), 1));
+    __m256i bl = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_and_si256(a, k1f), _mm256_and_si256(c, k1f)),
+        _mm256_slli_epi16(_mm256_and_si256(b, k1f), 1));
+    _mm256_storeu_si256((__m256i *)(hr + x), r);
+    _mm256_storeu_si256((__m256i *)(hg + x), g);
+    _mm256_storeu_si256((__m256i *)(hb + x), bl);
+  }
+  return x;
+}
+
+__attribute__((target("avx2"))) static inline __m256i gauss_v121_avx2(
+    const uint16_t *const h[3][3], int ch, int x) {
+  __m256i t = _mm256_loadu_si256((const __m256i *)(h[0][ch] + x));
+  __m256i m = _mm256_loadu_si256((const __m256i *)(h[1][ch] + x));
+  __m256i b = _mm256_loadu_si256((const __m256i *)(h[2][ch] + x));
+  return _mm256_srli_epi16(
+      _mm256_add_epi16(_mm256_add_epi16(t, b), _mm256_slli_epi16(m, 1)), 4);
+}
+
+__attribute__((target("avx2"))) static inline int gauss_vpass_avx2(
+    const uint16_t *const h[3][3], uint16_t *out, int x0, int x1) {
+  int x = x0;
+  for (; x + 16 <= x1; x += 16) {
+    __m256i r = gauss_v121_avx2(h, 0, x);
+    __m256i g = gauss_v121_avx2(h, 1, x);
+    __m256i b = gauss_v121_avx2(h, 2, x);
+    __m256i px = _mm256_or_si256(
+        _mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b);
+    _mm256_storeu_si256((__m256i *)(out + x), px);
+  }
+  return x;
+}
+
+static inline int gauss_have_avx2(void) {
+  static int have = -1;
+  if (have < 0) {
+    __builtin_cpu_init();
+    have = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return have;
+}
+#endif  // GAUSS_X86
+
+#if GAUSS_NEON
+// ---- NEON: 8 pixels per iteration ----
+static inline int gauss_hpass_neon(const uint16_t *in, uint16_t *hr,
+                                   uint16_t *hg, uint16_t *hb, int x0,
+                                   int x1) {
+  const uint16x8_t k3f = vdupq_n_u16(0x3F);
+  const uint16x8_t k1f = vdupq_n_u16(0x1F);
+  int x = x0;
+  for (; x + 8 <= x1; x += 8) {
+    uint16x8_t a = vld1q_u16(in + x - 1);
+    uint16x8_t b = vld1q_u16(in + x);
+    uint16x8_t c = vld1q_u16(in + x + 1);
+    vst1q_u16(hr + x, vaddq_u16(vaddq_u16(vshrq_n_u16(a, 11),
+                                          vshrq_n_u16(c, 11)),
+                                vshlq_n_u16(vshrq_n_u16(b, 11), 1)));
+    vst1q_u16(hg + x,
+              vaddq_u16(vaddq_u16(vandq_u16(vshrq_n_u16(a, 5), k3f),
+                                  vandq_u16(vshrq_n_u16(c, 5), k3f)),
+                        vshlq_n_u16(vandq_u16(vshrq_n_u16(b, 5), k3f), 1)));
+    vst1q_u16(hb + x, vaddq_u16(vaddq_u16(vandq_u16(a, k1f), vandq_u16(c, k1f)),
+                                vshlq_n_u16(vandq_u16(b, k1f), 1)));
+  }
+  return x;
+}
+
+static inline int gauss_vpass_neon(const uint16_t *const h[3][3],
+                                   uint16_t *out, int x0, int x1) {
+  int x = x0;
+  for (; x + 8 <= x1; x += 8) {
+    uint16x8_t c[3];
+    for (int ch = 0; ch < 3; ch++) {
+      uint16x8_t t = vld1q_u16(h[0][ch] + x);
+      uint16x8_t m = vld1q_u16(h[1][ch] + x);
+      uint16x8_t b = vld1q_u16(h[2][ch] + x);
+      c[ch] = vshrq_n_u16(vaddq_u16(vaddq_u16(t, b), vshlq_n_u16(m, 1)), 4);
+    }
+    vst1q_u16(out + x, vorrq_u16(vorrq_u16(vshlq_n_u16(c[0], 11),
+                                           vshlq_n_u16(c[1], 5)),
+                                 c[2]));
+  }
+  return x;
+}
+#endif  // GAUSS_NEON
+
+static inline void gauss_hpass(const uint16_t *in, uint16_t *hr, uint16_t *hg,
+                               uint16_t *hb, int w) {
+  int x = 1;
+#if GAUSS_X86
+  if (gauss_have_avx2()) x = gauss_hpass_avx2(in, hr, hg, hb, x, w - 1);
+  x = gauss_hpass_sse2(in, hr, hg, hb, x, w - 1);
+#elif GAUSS_NEON
+  x = gauss_hpass_neon(in, hr, hg, hb, x, w - 1);
+#endif
+  gauss_hpass_scalar(in, hr, hg, hb, x, w - 1);
+}
+
+static inline void gauss_vpass(const uint16_t *const h[3][3], uint16_t *out,
+                               int w) {
+  int x = 1;
+#if GAUSS_X86
+  if (gauss_have_avx2()) x = gauss_vpass_avx2(h, out, x, w - 1);
+  x = gauss_vpass_sse2(h, out, x, w - 1);
+#elif GAUSS_NEON
+  x = gauss_vpass_neon(h, out, x, w - 1);
+#endif
+  gauss_vpass_scalar(h, out, x, w - 1);
+}
+
+// Ring scratch needed by gauss_blur_rgb565_rows(), in uint16
+static inline size_t gauss_ring_words(int w) { return (size_t)9 * w; }
+
+static inline void gauss_copy_row(const uint16_t *in, uint16_t *out, int w,
+                                  int y) {
+  if (out != in)
+    memcpy(out + (size_t)y * w, in + (size_t)y * w, (size_t)w * sizeof(uint16_t));
+}
+
+// -------------------------------------------------------
+// Blur output rows [y_begin, y_end) of a w x h frame. The
+// band reads input rows y_begin-1 .. y_end (a 1-row halo),
+// so concurrent bands need out != in. ring is scratch of
+// gauss_ring_words(w) uint16.
+// -------------------------------------------------------
+static inline void gauss_blur_rgb565_rows(const uint16_t *in, uint16_t *out,
+                                          int w, int h, int y_begin, int y_end,
+                                          uint16_t *ring) {
+  if (w < 3 || h < 3) {
+    for (int y = y_begin; y < y_end; y++) gauss_copy_row(in, out, w, y);
+    return;
+  }
+
+  // 3 ring rows x 3 channels of horizontal sums, indexed by y % 3
+  uint16_t *slot[3][3];
+  for (int r = 0; r < 3; r++)
+    for (int c = 0; c < 3; c++) slot[r][c] = ring + (size_t)(r * 3 + c) * w;
+
+  // Row 0 and row h-1 are border rows
+  if (y_begin == 0) gauss_copy_row(in, out, w, 0);
+  int first = y_begin < 1 ? 1 : y_begin;
+  int last = y_end > h - 1 ? h - 1 : y_end;
+
+  if (first < last) {
+    // Prime the ring with the halo row and the first row
+    for (int y = first - 1; y <= first; y++) {
+      const uint16_t *src = in + (size_t)y * w;
+      gauss_hpass(src, slot[y % 3][0], slot[y % 3][1], slot[y % 3][2], w);
+    }
+  }
+
+  for (int y = first; y < last; y++) {
+    const uint16_t *next = in + (size_t)(y + 1) * w;
+    int top = (y - 1) % 3, mid = y % 3, bot = (y + 1) % 3;
+    gauss_hpass(next, slot[bot][0], slot[bot][1], slot[bot][2], w);
+
+    const uint16_t *const hv[3][3] = {
+        {slot[top][0], slot[top][1], slot[top][2]},
+        {slot[mid][0], slot[mid][1], slot[mid][2]},
+        {slot[bot][0], slot[bot][1], slot[bot][2]}};
+    uint16_t *o = out + (size_t)y * w;
+    const uint16_t *src = in + (size_t)y * w;
+    uint16_t left = src[0], right = src[w - 1];
+    gauss_vpass(hv, o, w);
+    // Left/right border columns pass through
+    o[0] = left;
+    o[w - 1] = right;
+  }
+
+  if (y_end == h) gauss_copy_row(in, out, w, h - 1);
+}
+
+// -------------------------------------------------------
+// Blur a w x h RGB565 frame. out may alias in (each input
+// row is consumed into the ring before its output row is
+// written). Returns 0 on success, -1 on allocation failure.
+// -------------------------------------------------------
+static inline int gauss_blur_rgb565(const uint16_t *in, uint16_t *out, int w,
+                                    int h) {
+  uint16_t *ring = (uint16_t *)malloc(gauss_ring_words(w) * sizeof(uint16_t));
+  if (!ring) return -1;
+  gauss_blur_rgb565_rows(in, out, w, h, 0, h, ring);
+  free(ring);
+  return 0;
+}
+
+#endif  // GAUSS_BLUR_H
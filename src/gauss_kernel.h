@@ -0,0 +1,371 @@
+#ifndef GAUSS_KERNEL_H
+#define GAUSS_KERNEL_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gauss_blur.h"
+
+// -------------------------------------------------------
+// Configurable (2R+1)x(2R+1) separable kernel, golden
+// model of gaussian_blur_rgb565_sep (src/gs_sep.v):
+//
+//  - the 2-D weight is coeff[i] * coeff[j]; the 1-D taps
+//    must sum to 1 << shift, the result is >> (2 * shift)
+//    per channel (truncating, no intermediate rounding)
+//  - with the default GAUSS_BORDER_PASS, rows/columns closer
+//    than R to an edge are copied through unchanged; the
+//    other border modes blur every pixel, filling taps that
+//    fall outside the frame by replicating the edge pixel,
+//    mirroring about it (reflect-101: ... 2 1 | 0 1 2 ...)
+//    or with zero, as BORDER does in gs.v
+//
+// Radius 1 with taps 1 2 1, shift 2 and pass-through borders
+// is exactly gauss_blur_rgb565() and is routed to that fast
+// path.
+// Build: add -lm for gauss_kernel_from_sigma().
+// -------------------------------------------------------
+
+#define GAUSS_KERNEL_MAX_RADIUS 7
+#define GAUSS_KERNEL_MAX_TAPS (2 * GAUSS_KERNEL_MAX_RADIUS + 1)
+// 63 * (1 << 2*shift) must fit the uint32 accumulators
+#define GAUSS_KERNEL_MAX_SHIFT 12
+
+// Values match the BORDER parameter of gs.v
+typedef enum {
+  GAUSS_BORDER_PASS = 0,
+  GAUSS_BORDER_REPLICATE = 1,
+  GAUSS_BORDER_MIRROR = 2,
+  GAUSS_BORDER_ZERO = 3
+} GaussBorder;
+
+typedef struct {
+  int radius;
+  int shift;  // taps sum to 1 << shift
+  uint16_t coeff[GAUSS_KERNEL_MAX_TAPS];
+  GaussBorder border;
+} GaussKernel;
+
+// "pass", "replicate", "mirror" or "zero". Returns 0, or -1
+// if the name is unknown.
+static inline int gauss_border_parse(const char *s, GaussBorder *b) {
+  static const char *const names[] = {"pass", "replicate", "mirror", "zero"};
+  for (int i = 0; i < 4; i++) {
+    if (strcmp(s, names[i]) == 0) {
+      *b = (GaussBorder)i;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+// Source index for tap position i of an n-pixel line, or -1
+// for a zero tap
+static inline int gauss_border_index(int i, int n, GaussBorder b) {
+  if (i >= 0 && i < n) return i;
+  if (b == GAUSS_BORDER_ZERO) return -1;
+  if (b == GAUSS_BORDER_REPLICATE || n == 1) return i < 0 ? 0 : n - 1;
+  int period = 2 * (n - 1);  // reflect-101
+  i %= period;
+  if (i < 0) i += period;
+  return i < n ? i : period - i;
+}
+
+static inline int gauss_kernel_taps(const GaussKernel *k) {
+  return 2 * k->radius + 1;
+}
+
+// The 3x3 1-2-1 kernel of gs.v
+static inline void gauss_kernel_default(GaussKernel *k) {
+  memset(k, 0, sizeof(*k));
+  k->radius = 1;
+  k->shift = 2;
+  k->coeff[0] = 1;
+  k->coeff[1] = 2;
+  k->coeff[2] = 1;
+}
+
+static inline int gauss_kernel_is_default(const GaussKernel *k) {
+  return k->radius == 1 && k->shift == 2 && k->coeff[0] == 1 &&
+         k->coeff[1] == 2 && k->coeff[2] == 1 &&
+         k->border == GAUSS_BORDER_PASS;
+}
+
+// Binomial taps (row 2R of Pascal's triangle), sum 4^R.
+// Returns 0, or -1 if the radius is out of range.
+static inline int gauss_kernel_binomial(GaussKernel *k, int radius) {
+  if (radius < 1 || 2 * radius > GAUSS_KERNEL_MAX_SHIFT) return -1;
+  memset(k, 0, sizeof(*k));
+  k->radius = radius;
+  k->shift = 2 * radius;
+  k->coeff[0] = 1;
+  for (int n = 1; n <= 2 * radius; n++)
+    for (int i = n; i > 0; i--) k->coeff[i] += k->coeff[i - 1];
+  return 0;
+}
+
+// Sampled Gaussian exp(-d^2 / 2 sigma^2), scaled so the taps
+// sum to 1 << shift; the rounding residue goes to the centre
+// tap. Returns 0, or -1 on bad arguments.
+static inline int gauss_kernel_from_sigma(GaussKernel *k, int radius,
+                                          double sigma, int shift) {
+  if (radius < 1 || radius > GAUSS_KERNEL_MAX_RADIUS || !(sigma > 0.0) ||
+      shift < 1 || shift > GAUSS_KERNEL_MAX_SHIFT)
+    return -1;
+  memset(k, 0, sizeof(*k));
+  k->radius = radius;
+  k->shift = shift;
+
+  double wsum = 0.0, wt[GAUSS_KERNEL_MAX_TAPS];
+  for (int i = 0; i <= 2 * radius; i++) {
+    double d = (double)(i - radius);
+    wt[i] = exp(-d * d / (2.0 * sigma * sigma));
+    wsum += wt[i];
+  }
+  long total = 0;
+  for (int i = 0; i <= 2 * radius; i++) {
+    k->coeff[i] = (uint16_t)lround(wt[i] / wsum * (double)(1L << shift));
+    total += k->coeff[i];
+  }
+  long centre = (long)k->coeff[radius] + ((1L << shift) - total);
+  if (centre <= 0) return -1;
+  k->coeff[radius] = (uint16_t)centre;
+  return 0;
+}
+
+// Parse "c0,c1,...,c2R": an odd number of taps whose sum is
+// a power of two. Returns 0, or -1 on a malformed list.
+static inline int gauss_kernel_parse(GaussKernel *k, const char *s) {
+  memset(k, 0, sizeof(*k));
+  int n = 0;
+  long sum = 0;
+  while (*s) {
+    char *end;
+    long v = strtol(s, &end, 10);
+    if (end == s || v < 0 || v > 0xFFFF || n == GAUSS_KERNEL_MAX_TAPS)
+      return -1;
+    k->coeff[n++] = (uint16_t)v;
+    sum += v;
+    s = end;
+    if (*s == ',')
+      s++;
+    else if (*s)
+      return -1;
+  }
+  if (n % 2 == 0 || sum <= 0 || (sum & (sum - 1)) != 0) return -1;
+  int shift = 0;
+  while ((1L << shift) < sum) shift++;
+  if (shift > GAUSS_KERNEL_MAX_SHIFT) return -1;
+  k->radius = n / 2;
+  k->shift = shift;
+  return 0;
+}
+
+// Ring scratch needed by gauss_blur_rgb565_kernel_rows(), in
+// uint32: 2R+1 rows x 3 channels of horizontal sums, plus one
+// padded source row for the filling border modes
+static inline size_t gauss_kernel_ring_words(const GaussKernel *k, int w) {
+  return (size_t)gauss_kernel_taps(k) * 3 * w + (size_t)w +
+         gauss_kernel_taps(k);
+}
+
+// Horizontal FIR for columns R..w-R-1 of one RGB565 row
+static inline void gauss_kernel_hpass(const GaussKernel *k, const uint16_t *in,
+                                      uint32_t *hr, uint32_t *hg, uint32_t *hb,
+                                      int w) {
+  int r = k->radius, taps = gauss_kernel_taps(k);
+  for (int x = r; x < w - r; x++) {
+    const uint16_t *p = in + x - r;
+    uint32_t sr = 0, sg = 0, sb = 0;
+    for (int i = 0; i < taps; i++) {
+      uint32_t c = k->coeff[i];
+      sr += c * (uint32_t)(p[i] >> 11);
+      sg += c * (uint32_t)((p[i] >> 5) & 0x3F);
+      sb += c * (uint32_t)(p[i] & 0x1F);
+    }
+    hr[x] = sr;
+    hg[x] = sg;
+    hb[x] = sb;
+  }
+}
+
+// Horizontal sums of source row y (any y; rows outside the
+// frame follow the border mode) for all w columns. pad holds
+// w + 2R uint32 of scratch.
+static inline void gauss_kernel_hpass_filled(const GaussKernel *k,
+                                             const uint16_t *in, int w, int h,
+                                             int y, uint32_t *hr, uint32_t *hg,
+                                             uint32_t *hb, uint32_t *pad) {
+  int r = k->radius;
+  int sy = gauss_border_index(y, h, k->border);
+  if (sy < 0) {
+    memset(hr, 0, (size_t)w * sizeof(uint32_t));
+    memset(hg, 0, (size_t)w * sizeof(uint32_t));
+    memset(hb, 0, (size_t)w * sizeof(uint32_t));
+    return;
+  }
+  const uint16_t *row = in + (size_t)sy * w;
+  for (int i = -r; i < w + r; i++) {
+    int sx = gauss_border_index(i, w, k->border);
+    pad[i + r] = sx < 0 ? 0 : row[sx];
+  }
+  int taps = gauss_kernel_taps(k);
+  for (int x = 0; x < w; x++) {
+    const uint32_t *p = pad + x;
+    uint32_t sr = 0, sg = 0, sb = 0;
+    for (int i = 0; i < taps; i++) {
+      uint32_t c = k->coeff[i];
+      sr += c * (p[i] >> 11);
+      sg += c * ((p[i] >> 5) & 0x3F);
+      sb += c * (p[i] & 0x1F);
+    }
+    hr[x] = sr;
+    hg[x] = sg;
+    hb[x] = sb;
+  }
+}
+
+// Filling border modes: every output row is blurred, taps
+// outside the frame come from gauss_border_index(). Reads
+// input rows y_begin-R .. y_end+R-1 (mirrored rows may reach
+// back further), so out must not alias in.
+static inline void gauss_blur_rgb565_kernel_rows_filled(
+    const GaussKernel *k, const uint16_t *in, uint16_t *out, int w, int h,
+    int y_begin, int y_end, uint32_t *ring) {
+  int r = k->radius, taps = gauss_kernel_taps(k);
+  uint32_t *slot[GAUSS_KERNEL_MAX_TAPS][3];
+  for (int s = 0; s < taps; s++)
+    for (int c = 0; c < 3; c++)
+      slot[s][c] = ring + (size_t)(s * 3 + c) * w;
+  uint32_t *pad = ring + (size_t)taps * 3 * w;
+
+  // Ring slot of virtual row v is (v - y_begin + taps) % taps
+  for (int v = y_begin - r; v < y_begin + r; v++) {
+    int s = (v - y_begin + taps) % taps;
+    gauss_kernel_hpass_filled(k, in, w, h, v, slot[s][0], slot[s][1],
+                              slot[s][2], pad);
+  }
+
+  int vshift = 2 * k->shift;
+  for (int y = y_begin; y < y_end; y++) {
+    int s = (y + r - y_begin + taps) % taps;
+    gauss_kernel_hpass_filled(k, in, w, h, y + r, slot[s][0], slot[s][1],
+                              slot[s][2], pad);
+
+    uint16_t *o = out + (size_t)y * w;
+    for (int x = 0; x < w; x++) {
+      uint32_t sr = 0, sg = 0, sb = 0;
+      for (int j = 0; j < taps; j++) {
+        int sj = (y - r + j - y_begin + taps) % taps;
+        uint32_t c = k->coeff[j];
+        sr += c * slot[sj][0][x];
+        sg += c * slot[sj][1][x];
+        sb += c * slot[sj][2][x];
+      }
+      o[x] = (uint16_t)(((sr >> vshift) << 11) | ((sg >> vshift) << 5) |
+                        (sb >> vshift));
+    }
+  }
+}
+
+// -------------------------------------------------------
+// Blur output rows [y_begin, y_end) of a w x h frame with
+// kernel k. The band reads input rows y_begin-R .. y_end+R-1,
+// so concurrent bands need out != in (and so does any
+// filling border mode). ring is scratch of
+// gauss_kernel_ring_words(k, w) uint32.
+// -------------------------------------------------------
+static inline void gauss_blur_rgb565_kernel_rows(const GaussKernel *k,
+                                                 const uint16_t *in,
+                                                 uint16_t *out, int w, int h,
+                                                 int y_begin, int y_end,
+                                                 uint32_t *ring) {
+  if (k->border != GAUSS_BORDER_PASS) {
+    gauss_blur_rgb565_kernel_rows_filled(k, in, out, w, h, y_begin, y_end,
+                                         ring);
+    return;
+  }
+  int r = k->radius, taps = gauss_kernel_taps(k);
+  int first = y_begin < r ? r : y_begin;
+  int last = y_end > h - r ? h - r : y_end;
+  if (w < taps || h < taps) last = first;  // no interior
+
+  // Border rows above and below the interior pass through
+  for (int y = y_begin; y < y_end && y < first; y++)
+    gauss_copy_row(in, out, w, y);
+  for (int y = last > first ? last : first; y < y_end; y++)
+    gauss_copy_row(in, out, w, y);
+  if (first >= last) return;
+
+  // taps ring rows x 3 channels, indexed by y % taps
+  uint32_t *slot[GAUSS_KERNEL_MAX_TAPS][3];
+  for (int s = 0; s < taps; s++)
+    for (int c = 0; c < 3; c++)
+      slot[s][c] = ring + (size_t)(s * 3 + c) * w;
+
+  // Prime the ring with rows first-R .. first+R-1
+  for (int y = first - r; y < first + r; y++) {
+    int s = y % taps;
+    gauss_kernel_hpass(k, in + (size_t)y * w, slot[s][0], slot[s][1],
+                       slot[s][2], w);
+  }
+
+  int vshift = 2 * k->shift;
+  for (int y = first; y < last; y++) {
+    int s = (y + r) % taps;
+    gauss_kernel_hpass(k, in + (size_t)(y + r) * w, slot[s][0], slot[s][1],
+                       slot[s][2], w);
+
+    // Border columns pass through; out may alias in here
+    gauss_copy_row(in, out, w, y);
+    uint16_t *o = out + (size_t)y * w;
+    for (int x = r; x < w - r; x++) {
+      uint32_t sr = 0, sg = 0, sb = 0;
+      for (int j = 0; j < taps; j++) {
+        int sj = (y - r + j) % taps;
+        uint32_t c = k->coeff[j];
+        sr += c * slot[sj][0][x];
+        sg += c * slot[sj][1][x];
+        sb += c * slot[sj][2][x];
+      }
+      o[x] = (uint16_t)(((sr >> vshift) << 11) | ((sg >> vshift) << 5) |
+                        (sb >> vshift));
+    }
+  }
+}
+
+// -------------------------------------------------------
+// Blur a w x h RGB565 frame with kernel k. out may alias
+// in: pass-through rows are written only after the rows
+// below them that they need have entered the ring, and the
+// filling modes (whose mirrored taps can reach back to
+// rows already written) blur from a copy. Returns 0 on
+// success, -1 on allocation failure.
+// -------------------------------------------------------
+static inline int gauss_blur_rgb565_kernel(const GaussKernel *k,
+                                           const uint16_t *in, uint16_t *out,
+                                           int w, int h) {
+  if (gauss_kernel_is_default(k)) return gauss_blur_rgb565(in, out, w, h);
+  uint16_t *copy = NULL;
+  if (out == in && k->border != GAUSS_BORDER_PASS) {
+    copy = (uint16_t *)malloc((size_t)w * h * sizeof(uint16_t));
+    if (!copy) return -1;
+    memcpy(copy, in, (size_t)w * h * sizeof(uint16_t));
+    in = copy;
+  }
+  uint32_t *ring =
+      (uint32_t *)malloc(gauss_kernel_ring_words(k, w) * sizeof(uint32_t));
+  if (!ring) {
+    free(copy);
+    return -1;
+  }
+  gauss_blur_rgb565_kernel_rows(k, in, out, w, h, 0, h, ring);
+  free(ring);
+  free(copy);
+  return 0;
+}
+
+#endif  // GAUSS_KERNEL_H
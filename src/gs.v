@@ -1,11 +1,36 @@
 // ============================================================
-// Gaussian Blur (3x3) for 320x240 RGB565 image stored in a HEX file
-// - Input HEX:  76800 lines, each 16-bit RGB565 (4 hex digits)
-// - Output HEX: 76800 lines, each 16-bit RGB565 (4 hex digits)
+// Gaussian Blur (3x3) for a WxH RGB565 image stored in a HEX file
+// - Input HEX:  W*H lines, each 16-bit RGB565 (4 hex digits);
+//               a leading "// RGB565 WxH" comment line is ignored
+// - Output HEX: W*H lines, each 16-bit RGB565 (4 hex digits)
 // Notes:
-//  - Uses $readmemh/$writememh (simulation-friendly)
-//  - Fixed to avoid 'xxxx' in output by always writing every output address
-//  - Adds 1-cycle alignment regs so window/address are consistent in simulation
+//  - W/H are parameters (default 320x240, the historical module
+//    name is kept); counter widths follow from them via $clog2
+//  - Uses $readmemh/$writememh (simulation-friendly); with GS_DPI
+//    defined, frames move through DPI-C calls instead, straight to
+//    and from a C buffer (test/sim_dpi.cpp)
+//  - Every output address is written exactly once, from the window,
+//    so blur_buffer never holds 'xxxx'. At PPC=1 that is a single
+//    write port. At PPC>1 a group starts W+1 pixels behind the scan,
+//    which is not a multiple of PPC, so the lanes write PPC
+//    consecutive 16-bit addresses (one per address bank mod PPC),
+//    not one aligned PPC-wide word
+//  - BORDER selects edge handling: PASS (0, default) copies edge
+//    pixels through unchanged; REPLICATE (1), MIRROR (2, reflect-101)
+//    and ZERO (3) fill the taps outside the frame and blur the edge
+//    pixels too. Interior pixels get the 1-2-1 / 2-4-2 / 1-2-1
+//    kernel, >>4 per channel
+//  - 3-stage pipeline: read -> window/line buffers -> write, with valid
+//    bits so every stage stays aligned with its own x/y/address. The
+//    scan runs W/PPC+1 flush groups past the last pixel to emit the
+//    bottom row
+//  - PPC pixels per clock: PPC-wide line buffer words, a (PPC+2)-column
+//    window and PPC sum trees; a frame takes about (N+W)/PPC clocks
+//  - ADD_PIPE registers the adder tree (row sums, then column sum);
+//    the write address is a counter rather than y*W+x
+//  - Bit-exact C golden model: gauss_blur_rgb565() in gauss_blur.h,
+//    or gauss_blur_rgb565_kernel() (gs_model --border=...) for the
+//    filling border modes
 // ============================================================
 
 `timescale 1ns/1ps
@@ -15,24 +40,58 @@
 // ------------------------------------------------------------
 module gaussian_blur_rgb565_320x240 #(
     // More ModelSim-friendly than "parameter string"
-    parameter IN_HEX = "output.hex"
+    parameter IN_HEX = "output.hex",
+    // 0: no $readmemh; the instantiating bench fills frame_buffer
+    parameter integer LOAD_HEX = 1,
+    parameter integer W = 320,
+    parameter integer H = 240,
+    // Pixels per clock: lanes read, blurred and written in parallel.
+    // W must be a multiple of PPC.
+    parameter integer PPC = 1,
+    // Register levels in the adder tree (0..2). Each level adds a clock
+    // of latency and shortens the window -> blur_buffer path.
+    parameter integer ADD_PIPE = 0,
+    // Edge handling: 0 pass, 1 replicate, 2 mirror, 3 zero
+    parameter integer BORDER = 0
 )(
     input  wire clk,
     input  wire rst,
     input  wire start,
     output reg  done
 );
-    localparam integer W = 320;
-    localparam integer H = 240;
-    localparam integer N = W*H;
+    localparam integer N  = W*H;
+    localparam integer XW = (W > 1) ? $clog2(W) : 1;
+    localparam integer YW = $clog2(H + 2);  // scan runs to row H+1
+    localparam integer AW = (N > 1) ? $clog2(N) : 1;
+    localparam integer WG = W / PPC;   // line-buffer words per row
+    localparam integer PW = 16 * PPC;  // line-buffer word width
+    localparam integer LW = $clog2(WG); // line-buffer word index width
+
+    // Scan limits and steps sized to their counters (width-clean compares)
+    localparam integer X_LAST_I    = W - PPC;
+    localparam integer Y_END_I     = H + 1;
+    localparam integer OUT_START_I = -(W + 1);
+    localparam [XW-1:0] X_LAST    = X_LAST_I[XW-1:0];     // last group's x
+    localparam [XW-1:0] X_STEP    = PPC[XW-1:0];
+    localparam [YW-1:0] Y_H       = H[YW-1:0];            // first flush row
+    localparam [YW-1:0] Y_END     = Y_END_I[YW-1:0];      // last flush row
+    localparam [AW-1:0] A_STEP    = PPC[AW-1:0];
+    localparam [AW-1:0] OUT_START = OUT_START_I[AW-1:0];  // -(W+1) mod 2^AW
+
+    localparam integer BORDER_PASS      = 0;
+    localparam integer BORDER_REPLICATE = 1;
+    localparam integer BORDER_MIRROR    = 2;
+    localparam integer BORDER_ZERO      = 3;
 
     // ----------------------------
     // Input frame buffer (RGB565)
     // ----------------------------
     reg [15:0] frame_buffer [0:N-1];
+`ifndef GS_DPI
     initial begin
-        $readmemh(IN_HEX, frame_buffer);
+        if (LOAD_HEX != 0) $readmemh(IN_HEX, frame_buffer);
     end
+`endif
 
     // ----------------------------
     // Output blurred buffer (RGB565)
@@ -40,147 +99,339 @@ module gaussian_blur_rgb565_320x240 #(
     reg [15:0] blur_buffer [0:N-1];
 
     // ----------------------------
-    // Two line buffers (previous 2 rows)
+    // Two line buffers (previous 2 rows), PPC pixels per word
     // ----------------------------
-    reg [15:0] line1 [0:W-1];  // row y-1
-    reg [15:0] line2 [0:W-1];  // row y-2
-
-    // Scan counters
-    reg [8:0]  x;      // 0..319
-    reg [7:0]  y;      // 0..239
-    reg [16:0] addr;   // 0..76799
-    reg        running;
-
-    // 1-cycle delayed counters/address to align with pipeline
-    reg [8:0]  x_d;
-    reg [7:0]  y_d;
-    reg [16:0] addr_d;
-
-    // Current and tapped pixels
-    reg [15:0] p_in;
-    reg [15:0] p_mid;
-    reg [15:0] p_top;
-
-    // 1-cycle delayed input pixel used for guaranteed-defined write
-    reg [15:0] p_in_d;
-
-    // 3x3 window shift regs
-    reg [15:0] r0_0, r0_1, r0_2;
-    reg [15:0] r1_0, r1_1, r1_2;
-    reg [15:0] r2_0, r2_1, r2_2;
-
-    // Channel extract helpers
-    function automatic [4:0] R5(input [15:0] p); begin R5 = p[15:11]; end endfunction
-    function automatic [5:0] G6(input [15:0] p); begin G6 = p[10:5];  end endfunction
-    function automatic [4:0] B5(input [15:0] p); begin B5 = p[4:0];   end endfunction
+    reg [PW-1:0] line1 [0:WG-1];  // row y-1
+    reg [PW-1:0] line2 [0:WG-1];  // row y-2
+
+    // Scan counters (stage 0: read address of the first lane).
+    // Rows H and H+1 are flush rows: nothing is read, zeros enter
+    // the window, and the border logic never lets them through.
+    reg [XW-1:0] x;     // 0..W-PPC, step PPC
+    reg [YW-1:0] y;     // 0..H+1
+    reg [AW-1:0] addr;  // 0..N-PPC, step PPC
+    reg          running;
+
+    // Stage 1: PPC pixels starting at (x_d,y_d) and the pixels above them
+    reg [XW-1:0] x_d;
+    reg [YW-1:0] y_d;
+    reg          v_d;
+    reg          last_d;
+
+    // Current and tapped pixels, lane j in bits [16*j +: 16]
+    reg [PW-1:0] p_in;
+    reg [PW-1:0] p_mid;
+    reg [PW-1:0] p_top;
+
+    // Stage 2: window columns 2..PPC+1 hold (x_dd..x_dd+PPC-1, y_dd);
+    // lane k is centred on (x_dd-1+k, y_dd-1), except lane 0 at
+    // x_dd == 0, which is centred on the previous scan row's last
+    // pixel (W-1, y_dd-2)
+    reg [XW-1:0] x_dd;
+    reg [YW-1:0] y_dd;
+    reg          v_dd;
+    reg          last_dd;
+
+    // Set on the edge that performs the final write; done follows it
+    reg          fin;
+
+    // (PPC+2)-column x 3-row window, column c in bits [16*c +: 16]
+    reg [16*(PPC+2)-1:0] win_top;  // row y_dd-2
+    reg [16*(PPC+2)-1:0] win_mid;  // row y_dd-1
+    reg [16*(PPC+2)-1:0] win_bot;  // row y_dd
+
+    // Channel extract helpers, zero-extended to the 8-bit row-sum width
+    function automatic [7:0] R5(input [15:0] p); begin R5 = {3'd0, p[15:11]}; end endfunction
+    function automatic [7:0] G6(input [15:0] p); begin G6 = {2'd0, p[10:5]};  end endfunction
+    function automatic [7:0] B5(input [15:0] p); begin B5 = {3'd0, p[4:0]};   end endfunction
+
+    // Tap that replaces an out-of-frame one: `near` is the centre
+    // row/column, `far` the tap on the opposite side
+    function automatic [15:0] fill(input [15:0] near, input [15:0] far);
+        begin
+            case (BORDER)
+                BORDER_MIRROR: fill = far;
+                BORDER_ZERO:   fill = 16'h0000;
+                default:       fill = near;  // replicate
+            endcase
+        end
+    endfunction
 
     // Gaussian weights:
     // 1 2 1
     // 2 4 2   all / 16
     // 1 2 1
-    wire [9:0] sumR =
-        (R5(r0_0)) + (R5(r0_1)<<1) + (R5(r0_2)) +
-        (R5(r1_0)<<1) + (R5(r1_1)<<2) + (R5(r1_2)<<1) +
-        (R5(r2_0)) + (R5(r2_1)<<1) + (R5(r2_2));
+    // One sum tree per lane over window columns k..k+2, split as
+    // row sums (a + 2b + c) then column sum (top + 2*mid + bot), with
+    // an optional register after each level (ADD_PIPE)
+    wire [PW-1:0] blurred_pixels;
+    wire [PPC-1:0] we_dd;  // lane k's centre is inside the frame
+
+    integer j;
+    genvar k;
+    generate
+        for (k = 0; k < PPC; k = k + 1) begin : lane
+            wire [15:0] t0 = win_top[16*k +: 16];
+            wire [15:0] t1 = win_top[16*(k+1) +: 16];
+            wire [15:0] t2 = win_top[16*(k+2) +: 16];
+            wire [15:0] m0 = win_mid[16*k +: 16];
+            wire [15:0] m1 = win_mid[16*(k+1) +: 16];
+            wire [15:0] m2 = win_mid[16*(k+2) +: 16];
+            wire [15:0] b0 = win_bot[16*k +: 16];
+            wire [15:0] b1 = win_bot[16*(k+1) +: 16];
+            wire [15:0] b2 = win_bot[16*(k+2) +: 16];
+
+            // Where this lane's centre sits in the frame; only lanes 0
+            // and 1 can reach column 0 (at x_dd == 1 - k)
+            localparam integer L_X_I = (k <= 1) ? 1 - k : 0;
+            localparam [XW-1:0] L_X = L_X_I[XW-1:0];
+            wire wrap = (k == 0) && (x_dd == 0);
+            wire at_l = !wrap && (k <= 1) && (x_dd == L_X);
+            wire at_r = wrap;  // x == W-1 only ever lands on a wrap lane
+            wire at_t = wrap ? (y_dd == 2) : (y_dd == 1);
+            wire at_b = wrap ? (y_dd == Y_END) : (y_dd == Y_H);
+
+            assign we_dd[k] = wrap ? (y_dd >= 2) : (y_dd >= 1 && y_dd <= Y_H);
+
+            // Rows first: replace the top/bottom row outside the frame
+            wire [15:0] u0 = at_t ? fill(m0, b0) : t0;
+            wire [15:0] u1 = at_t ? fill(m1, b1) : t1;
+            wire [15:0] u2 = at_t ? fill(m2, b2) : t2;
+            wire [15:0] d0 = at_b ? fill(m0, t0) : b0;
+            wire [15:0] d1 = at_b ? fill(m1, t1) : b1;
+            wire [15:0] d2 = at_b ? fill(m2, t2) : b2;
+
+            // Then columns, on the row-filled values (corners follow)
+            wire [15:0] f00 = at_l ? fill(u1, u2) : u0;
+            wire [15:0] f10 = at_l ? fill(m1, m2) : m0;
+            wire [15:0] f20 = at_l ? fill(d1, d2) : d0;
+            wire [15:0] f02 = at_r ? fill(u1, u0) : u2;
+            wire [15:0] f12 = at_r ? fill(m1, m0) : m2;
+            wire [15:0] f22 = at_r ? fill(d1, d0) : d2;
+
+            // PASS: an edge centre blurs a window of copies of itself,
+            // which the kernel returns unchanged (16*p >> 4 == p)
+            wire on_edge = at_l || at_r || at_t || at_b;
+            wire pass = (BORDER == BORDER_PASS) && on_edge;
+            wire [15:0] w00 = pass ? m1 : f00;
+            wire [15:0] w01 = pass ? m1 : u1;
+            wire [15:0] w02 = pass ? m1 : f02;
+            wire [15:0] w10 = pass ? m1 : f10;
+            wire [15:0] w11 = m1;
+            wire [15:0] w12 = pass ? m1 : f12;
+            wire [15:0] w20 = pass ? m1 : f20;
+            wire [15:0] w21 = pass ? m1 : d1;
+            wire [15:0] w22 = pass ? m1 : f22;
+
+            // Level 1: 1-2-1 row sums, {R,G,B} x {top,mid,bot}
+            wire [71:0] rows = {
+                R5(w00) + (R5(w01)<<1) + R5(w02),
+                R5(w10) + (R5(w11)<<1) + R5(w12),
+                R5(w20) + (R5(w21)<<1) + R5(w22),
+                G6(w00) + (G6(w01)<<1) + G6(w02),
+                G6(w10) + (G6(w11)<<1) + G6(w12),
+                G6(w20) + (G6(w21)<<1) + G6(w22),
+                B5(w00) + (B5(w01)<<1) + B5(w02),
+                B5(w10) + (B5(w11)<<1) + B5(w12),
+                B5(w20) + (B5(w21)<<1) + B5(w22)
+            };
+            wire [71:0] rows_q;
+
+            // Level 2: 1-2-1 column sum per channel
+            wire [9:0] sumR = {2'd0, rows_q[71:64]} + ({2'd0, rows_q[63:56]}<<1) + {2'd0, rows_q[55:48]};
+            wire [9:0] sumG = {2'd0, rows_q[47:40]} + ({2'd0, rows_q[39:32]}<<1) + {2'd0, rows_q[31:24]};
+            wire [9:0] sumB = {2'd0, rows_q[23:16]} + ({2'd0, rows_q[15:8]}<<1)  + {2'd0, rows_q[7:0]};
+            wire [15:0] px  = {sumR[8:4], sumG[9:4], sumB[8:4]};  // /16
+
+            if (ADD_PIPE >= 1) begin : rows_reg
+                reg [71:0] r;
+                always @(posedge clk) r <= rows;
+                assign rows_q = r;
+            end else begin : rows_comb
+                assign rows_q = rows;
+            end
 
-    wire [9:0] sumG =
-        (G6(r0_0)) + (G6(r0_1)<<1) + (G6(r0_2)) +
-        (G6(r1_0)<<1) + (G6(r1_1)<<2) + (G6(r1_2)<<1) +
-        (G6(r2_0)) + (G6(r2_1)<<1) + (G6(r2_2));
+            if (ADD_PIPE >= 2) begin : sum_reg
+                reg [15:0] r;
+                always @(posedge clk) r <= px;
+                assign blurred_pixels[16*k +: 16] = r;
+            end else begin : sum_comb
+                assign blurred_pixels[16*k +: 16] = px;
+            end
+        end
+    endgenerate
+
+    // The per-lane enables, valid and last flag travel alongside the
+    // adder tree for ADD_PIPE clocks.
+    localparam integer CW = PPC + 2;
+    wire [CW-1:0]  ctl_dd = {v_dd && last_dd, v_dd, we_dd};
+    wire [CW-1:0]  ctl_w;
+    wire [PPC-1:0] we_w   = ctl_w[PPC-1:0];
+    wire           v_w    = ctl_w[PPC];
+    wire           last_w = ctl_w[PPC+1];
+
+    generate
+        if (ADD_PIPE >= 1) begin : ctl_reg
+            reg [CW*ADD_PIPE-1:0] sr;
+            // {sr, ctl_dd} is one entry too wide: the oldest falls off
+            /* verilator lint_off WIDTH */
+            always @(posedge clk) sr <= rst ? 0 : {sr, ctl_dd};
+            /* verilator lint_on WIDTH */
+            assign ctl_w = sr[CW*ADD_PIPE-1 -: CW];
+        end else begin : ctl_comb
+            assign ctl_w = ctl_dd;
+        end
+    endgenerate
 
-    wire [9:0] sumB =
-        (B5(r0_0)) + (B5(r0_1)<<1) + (B5(r0_2)) +
-        (B5(r1_0)<<1) + (B5(r1_1)<<2) + (B5(r1_2)<<1) +
-        (B5(r2_0)) + (B5(r2_1)<<1) + (B5(r2_2));
+    // Output address counter: centre of lane 0 for the group at the
+    // write stage, i.e. W+1 pixels behind the window's newest column.
+    // Starts at -(W+1) and steps by PPC per group; lanes outside the
+    // frame are never written, so the written ones stay in range.
+    reg [AW-1:0] out_addr;
 
-    wire [4:0] blurR = sumR[9:4]; // /16
-    wire [5:0] blurG = sumG[9:4]; // /16
-    wire [4:0] blurB = sumB[9:4]; // /16
+    // Line-buffer word of the read (x) and write (x_d) columns
+    wire [XW-1:0] x_word   = x / X_STEP;
+    wire [XW-1:0] x_d_word = x_d / X_STEP;
 
-    wire [15:0] blurred_pixel = {blurR, blurG, blurB};
+    initial begin
+        if (PPC < 1 || W % PPC != 0 || W < 2*PPC || H < 2) begin
+            $display("gaussian_blur_rgb565_320x240: W=%0d must be a multiple of PPC=%0d and at least 2*PPC, H>=2",
+                     W, PPC);
+            $finish;
+        end
+        if (ADD_PIPE < 0 || ADD_PIPE > 2) begin
+            $display("gaussian_blur_rgb565_320x240: ADD_PIPE=%0d must be 0, 1 or 2",
+                     ADD_PIPE);
+            $finish;
+        end
+        if (BORDER < 0 || BORDER > 3) begin
+            $display("gaussian_blur_rgb565_320x240: BORDER=%0d must be 0..3", BORDER);
+            $finish;
+        end
+    end
 
-    // Window valid after x_d>=2,y_d>=2; output aligns to center (x_d-1,y_d-1)
-    wire [8:0]  out_x    = x_d - 1;
-    wire [7:0]  out_y    = y_d - 1;
-    wire [16:0] out_addr = out_y * W + out_x;
+`ifdef GS_DPI
+    // ----------------------------
+    // In-process frame exchange (simulation only): each start pulls
+    // the input frame from the C side, and the cycle done is raised
+    // on pushes blur_buffer back (test/sim_dpi.cpp). IN_HEX is unused.
+    // ----------------------------
+    import "DPI-C" function int  gs_dpi_get_pixel(input int idx);
+    import "DPI-C" function void gs_dpi_put_pixel(input int idx, input int pixel);
 
-    integer i;
+    integer    dpi_i;  // not k: that is the lane genvar
+    reg [31:0] dpi_word;
+
+    always @(posedge clk) begin
+        if (!rst && start && !running) begin
+            for (dpi_i = 0; dpi_i < N; dpi_i = dpi_i + 1) begin
+                dpi_word = gs_dpi_get_pixel(dpi_i);
+                frame_buffer[dpi_i[AW-1:0]] = dpi_word[15:0];
+            end
+        end
+        // fin: the final write landed on the previous edge
+        if (!rst && fin) begin
+            for (dpi_i = 0; dpi_i < N; dpi_i = dpi_i + 1)
+                gs_dpi_put_pixel(dpi_i, {16'd0, blur_buffer[dpi_i[AW-1:0]]});
+        end
+    end
+`endif
 
     always @(posedge clk) begin
         if (rst) begin
             x <= 0; y <= 0; addr <= 0;
-            x_d <= 0; y_d <= 0; addr_d <= 0;
+            x_d <= 0; y_d <= 0;
+            x_dd <= 0; y_dd <= 0;
+            v_d <= 0; v_dd <= 0;
+            last_d <= 0; last_dd <= 0;
+            out_addr <= OUT_START;
+            fin <= 0;
             running <= 0;
             done <= 0;
 
             p_in <= 0; p_mid <= 0; p_top <= 0;
-            p_in_d <= 0;
 
-            r0_0<=0; r0_1<=0; r0_2<=0;
-            r1_0<=0; r1_1<=0; r1_2<=0;
-            r2_0<=0; r2_1<=0; r2_2<=0;
+            win_top <= 0; win_mid <= 0; win_bot <= 0;
 
-            for (i=0; i<W; i=i+1) begin
-                line1[i] <= 0;
-                line2[i] <= 0;
-            end
+            // line1/line2 need no reset: rows outside the frame are
+            // always replaced by the border logic, so nothing from a
+            // previous frame leaks through
         end else begin
-            done <= 0;
+            // Pulse done once the final write has landed
+            fin  <= last_w;
+            done <= fin;
 
             if (start && !running) begin
                 running <= 1;
                 x <= 0; y <= 0; addr <= 0;
-                x_d <= 0; y_d <= 0; addr_d <= 0;
+                out_addr <= OUT_START;
             end
 
+            // ---------------- Stage 0 -> 1 ----------------
+            v_d    <= running;
+            last_d <= running && (x == 0) && (y == Y_END);
+
             if (running) begin
-                // Read pixel at (x,y)
-                p_in  <= frame_buffer[addr];
+                // Read PPC pixels starting at (x,y); flush rows feed zeros
+                if (y < Y_H) begin
+                    // Lane loops index with the integer j
+                    /* verilator lint_off WIDTH */
+                    for (j=0; j<PPC; j=j+1)
+                        p_in[16*j +: 16] <= frame_buffer[addr + j];
+                    /* verilator lint_on WIDTH */
+                    addr <= addr + A_STEP;
+                end else begin
+                    p_in <= 0;
+                end
 
                 // Taps from previous rows at same x
-                p_mid <= line1[x];
-                p_top <= line2[x];
+                p_mid <= line1[x_word[LW-1:0]];
+                p_top <= line2[x_word[LW-1:0]];
 
-                // Delay counters/address for aligned writes
                 x_d    <= x;
                 y_d    <= y;
-                addr_d <= addr;
 
-                // Delay pixel to ensure defined copy-out each address
-                p_in_d <= p_in;
+                // Advance scan; (0,H+1) emits the last pixel
+                if (x == 0 && y == Y_END) begin
+                    running <= 0;
+                end else if (x == X_LAST) begin
+                    x <= 0;
+                    y <= y + 1;
+                end else begin
+                    x <= x + X_STEP;
+                end
+            end
 
-                // Shift 3x3 window, insert newest column on the right
-                r0_0 <= r0_1;  r0_1 <= r0_2;  r0_2 <= p_top;
-                r1_0 <= r1_1;  r1_1 <= r1_2;  r1_2 <= p_mid;
-                r2_0 <= r2_1;  r2_1 <= r2_2;  r2_2 <= p_in;
+            // ---------------- Stage 1 -> 2 ----------------
+            v_dd    <= v_d;
+            last_dd <= v_d && last_d;
 
-                // Update line buffers
-                line2[x] <= line1[x];
-                line1[x] <= p_in;
+            if (v_d) begin
+                // Shift the window PPC columns left, newest pixels on the right
+                win_top <= {p_top, win_top[16*(PPC+2)-1 -: 32]};
+                win_mid <= {p_mid, win_mid[16*(PPC+2)-1 -: 32]};
+                win_bot <= {p_in,  win_bot[16*(PPC+2)-1 -: 32]};
 
-                // FIX: Always write a defined value to every output address.
-                // This prevents 'xxxx' in the written hex.
-                blur_buffer[addr_d] <= p_in_d;
+                // Update line buffers at the column p_in came from
+                // (stage 0 is already reading the next column)
+                line2[x_d_word[LW-1:0]] <= p_mid;
+                line1[x_d_word[LW-1:0]] <= p_in;
 
-                // Overwrite interior pixels when window is valid
-                if (x_d >= 2 && y_d >= 2) begin
-                    blur_buffer[out_addr] <= blurred_pixel;
-                end
+                x_dd <= x_d;
+                y_dd <= y_d;
+            end
 
-                // Advance scan
-                if (addr == N-1) begin
-                    running <= 0;
-                    done <= 1;
-                end else begin
-                    addr <= addr + 1;
-
-                    if (x == W-1) begin
-                        x <= 0;
-                        y <= y + 1;
-                    end else begin
-                        x <= x + 1;
-                    end
-                end
+            // ---------------- Stage 2 (+ADD_PIPE): write ----------------
+            // The only write into blur_buffer: one PPC-pixel group per
+            // clock, lanes whose centre lies outside the frame masked.
+            // The group is unaligned for PPC>1 (see the header)
+            if (v_w) begin
+                /* verilator lint_off WIDTH */
+                for (j=0; j<PPC; j=j+1)
+                    if (we_w[j])
+                        blur_buffer[out_addr + j] <= blurred_pixels[16*j +: 16];
+                /* verilator lint_on WIDTH */
+                out_addr <= out_addr + A_STEP;
             end
         end
     end
@@ -202,8 +453,22 @@ module tb_gaussian_blur;
     localparam INFILE  = "output.hex";
     localparam OUTFILE = "blurred.hex";
 
+    // Frame geometry; override to match bmp_to_hex --size=WxH
+    // (and pass the same --size to convert, as $writememh adds
+    // no geometry header)
+    parameter integer W = 320;
+    parameter integer H = 240;
+    parameter integer PPC = 1;       // pixels per clock
+    parameter integer ADD_PIPE = 0;  // adder-tree register levels
+    parameter integer BORDER = 0;    // 0 pass, 1 replicate, 2 mirror, 3 zero
+
     gaussian_blur_rgb565_320x240 #(
-        .IN_HEX(INFILE)
+        .IN_HEX(INFILE),
+        .W(W),
+        .H(H),
+        .PPC(PPC),
+        .ADD_PIPE(ADD_PIPE),
+        .BORDER(BORDER)
     ) dut (
         .clk(clk),
         .rst(rst),
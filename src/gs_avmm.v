@@ -0,0 +1,601 @@
+// ============================================================
+// Gaussian Blur (3x3) between two frames in external memory
+// (SDRAM/DDR behind Avalon-MM, as on the DE1-SoC)
+// - rgb565_avmm_reader streams the source frame out of memory with
+//   burst reads into a FIFO and presents it as AXI4-Stream video;
+//   gaussian_blur_rgb565_axis blurs it; rgb565_avmm_writer collects
+//   the result in a second FIFO and writes it back in bursts
+// - Bursts never cross a row (rows are STRIDE bytes apart, so padded
+//   frame buffers work); a W-pixel row is ceil(W/BURST) bursts
+// - The reader keeps issuing bursts while the FIFO has room for one
+//   more, counting words still in flight, so up to DEPTH words are
+//   requested ahead of the core. With DEPTH >= read latency + BURST
+//   the core never waits on memory and the chain runs at 1 pixel per
+//   clock; the writer only starts a burst once all of its words are
+//   in the FIFO, so it never stalls mid-burst
+// - Bit-exact with gaussian_blur_rgb565_320x240 / gauss_blur_rgb565()
+// Notes:
+//  - 16-bit data bus, one pixel per beat; addresses are byte
+//    addresses (Avalon-MM master convention), 2 bytes per pixel
+//  - Writes are posted: done pulses once the last write beat has
+//    been accepted (waitrequest low)
+//  - src_base/dst_base are sampled on start
+// ============================================================
+
+`timescale 1ns/1ps
+
+// ------------------------------------------------------------
+// Show-ahead FIFO: q is valid while q_valid, popped by q_ready.
+// Storage is a registered-read RAM plus the output register, so
+// it maps to block RAM and still moves one word per clock.
+// ------------------------------------------------------------
+module rgb565_fifo #(
+    parameter integer DW    = 16,
+    parameter integer DEPTH = 512,     // power of two
+    parameter integer CW    = $clog2(DEPTH + 2)  // derived
+)(
+    input  wire          clk,
+    input  wire          rst,
+
+    input  wire [DW-1:0] d,
+    input  wire          d_valid,      // caller keeps count < DEPTH+1
+
+    output reg  [DW-1:0] q,
+    output reg           q_valid,
+    input  wire          q_ready,
+
+    output wire [CW-1:0] count         // words held, q included
+);
+    localparam integer PW = (DEPTH > 1) ? $clog2(DEPTH) : 1;
+
+    initial begin
+        if (DEPTH < 2 || (DEPTH & (DEPTH - 1)) != 0) begin
+            $display("rgb565_fifo: DEPTH=%0d must be a power of two", DEPTH);
+            $finish;
+        end
+    end
+
+    reg [DW-1:0] mem [0:DEPTH-1];
+    reg [PW-1:0] wp, rp;
+    reg [CW-1:0] used;                 // words in mem
+
+    wire pop = (used != 0) && (!q_valid || q_ready);
+
+    assign count = used + {{(CW-1){1'b0}}, q_valid};
+
+    always @(posedge clk) begin
+        if (d_valid)
+            mem[wp] <= d;
+        if (pop)
+            q <= mem[rp];
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            wp <= 0; rp <= 0; used <= 0;
+            q_valid <= 0;
+        end else begin
+            if (d_valid) wp <= wp + 1;
+            if (pop)     rp <= rp + 1;
+            used <= used + (d_valid ? 1 : 0) - (pop ? 1 : 0);
+
+            if (pop)
+                q_valid <= 1;
+            else if (q_ready)
+                q_valid <= 0;
+        end
+    end
+endmodule
+
+
+// ------------------------------------------------------------
+// Frame reader: Avalon-MM burst read master -> AXI4-Stream video
+// (tuser = SOF, tlast = EOL)
+// ------------------------------------------------------------
+module rgb565_avmm_reader #(
+    parameter integer W      = 320,
+    parameter integer H      = 240,
+    parameter integer STRIDE = 2*W,    // bytes from row to row
+    parameter integer BURST  = 32,     // max words per burst
+    parameter integer DEPTH  = 512,    // FIFO words, power of two >= BURST
+    parameter integer ADDR_W = 32,
+    parameter integer BCW    = $clog2(BURST + 1)  // derived
+)(
+    input  wire              clk,
+    input  wire              rst,
+    input  wire              start,
+    input  wire [ADDR_W-1:0] base,
+
+    // Avalon-MM read master
+    output reg  [ADDR_W-1:0] avm_address,
+    output reg               avm_read,
+    output reg  [BCW-1:0]    avm_burstcount,
+    input  wire              avm_waitrequest,
+    input  wire [15:0]       avm_readdata,
+    input  wire              avm_readdatavalid,
+
+    // AXI4-Stream master
+    output wire [15:0]       m_axis_tdata,
+    output wire              m_axis_tvalid,
+    input  wire              m_axis_tready,
+    output wire              m_axis_tuser,
+    output wire              m_axis_tlast
+);
+    localparam integer XW = (W > 1) ? $clog2(W) : 1;
+    localparam integer YW = (H > 1) ? $clog2(H) : 1;
+    localparam integer CW = $clog2(DEPTH + 2);
+
+    initial begin
+        if (BURST < 1 || DEPTH < BURST) begin
+            $display("rgb565_avmm_reader: need 1 <= BURST=%0d <= DEPTH=%0d",
+                     BURST, DEPTH);
+            $finish;
+        end
+    end
+
+    // ---------------- Command side ----------------
+    reg              cmd_busy;
+    reg [XW-1:0]     c_x;              // column of the next burst
+    reg [YW-1:0]     c_y;
+    reg [ADDR_W-1:0] c_row;            // byte address of row c_y
+
+    // Words requested and not yet popped by the stream side
+    reg [CW-1:0]     reserved;
+
+    wire [XW:0]    c_left = W - c_x;
+    wire [31:0]    c_len32 = (c_left > BURST) ? BURST : c_left;
+    wire [BCW-1:0] c_len = c_len32[BCW-1:0];
+    wire cmd_done = avm_read && !avm_waitrequest;
+    wire can_issue = cmd_busy && (!avm_read || cmd_done) &&
+                     (reserved + (cmd_done ? avm_burstcount : 0) + c_len
+                      <= DEPTH);
+
+    wire          pop = m_axis_tvalid && m_axis_tready;
+
+    always @(posedge clk) begin
+        if (rst) begin
+            cmd_busy <= 0;
+            c_x <= 0; c_y <= 0; c_row <= 0;
+            avm_read <= 0; avm_address <= 0; avm_burstcount <= 0;
+            reserved <= 0;
+        end else begin
+            if (start && !cmd_busy) begin
+                cmd_busy <= 1;
+                c_x <= 0; c_y <= 0; c_row <= base;
+            end
+
+            reserved <= reserved + (cmd_done ? avm_burstcount : 0) -
+                        (pop ? 1 : 0);
+
+            if (cmd_done)
+                avm_read <= 0;
+            if (can_issue) begin
+                avm_read       <= 1;
+                avm_address    <= c_row + 2*c_x;
+                avm_burstcount <= c_len;
+                if (c_left > BURST) begin
+                    c_x <= c_x + BURST;
+                end else begin
+                    c_x <= 0;
+                    c_row <= c_row + STRIDE;
+                    if (c_y != H-1)
+                        c_y <= c_y + 1;
+                    else begin
+                        c_y <= 0;
+                        cmd_busy <= 0;   // last burst of the frame
+                    end
+                end
+            end
+        end
+    end
+
+    // ---------------- Stream side ----------------
+    rgb565_fifo #(
+        .DW(16),
+        .DEPTH(DEPTH)
+    ) fifo (
+        .clk(clk),
+        .rst(rst),
+        .d(avm_readdata),
+        .d_valid(avm_readdatavalid),
+        .q(m_axis_tdata),
+        .q_valid(m_axis_tvalid),
+        .q_ready(m_axis_tready),
+        .count()
+    );
+
+    reg [XW-1:0] s_x;
+    reg [YW-1:0] s_y;
+
+    assign m_axis_tuser = (s_x == 0) && (s_y == 0);
+    assign m_axis_tlast = (s_x == W-1);
+
+    always @(posedge clk) begin
+        if (rst) begin
+            s_x <= 0; s_y <= 0;
+        end else if (pop) begin
+            if (s_x != W-1) begin
+                s_x <= s_x + 1;
+            end else begin
+                s_x <= 0;
+                s_y <= (s_y == H-1) ? 0 : s_y + 1;
+            end
+        end
+    end
+endmodule
+
+
+// ------------------------------------------------------------
+// Frame writer: AXI4-Stream video -> Avalon-MM burst write master.
+// Input is taken in raster order from start; tuser/tlast are not
+// checked.
+// ------------------------------------------------------------
+module rgb565_avmm_writer #(
+    parameter integer W      = 320,
+    parameter integer H      = 240,
+    parameter integer STRIDE = 2*W,
+    parameter integer BURST  = 32,
+    parameter integer DEPTH  = 512,    // FIFO words, power of two >= BURST
+    parameter integer ADDR_W = 32,
+    parameter integer BCW    = $clog2(BURST + 1)  // derived
+)(
+    input  wire              clk,
+    input  wire              rst,
+    input  wire              start,
+    input  wire [ADDR_W-1:0] base,
+    output reg               done,
+
+    // AXI4-Stream slave
+    input  wire [15:0]       s_axis_tdata,
+    input  wire              s_axis_tvalid,
+    output wire              s_axis_tready,
+
+    // Avalon-MM write master
+    output reg  [ADDR_W-1:0] avm_address,
+    output wire              avm_write,
+    output reg  [BCW-1:0]    avm_burstcount,
+    output wire [15:0]       avm_writedata,
+    input  wire              avm_waitrequest
+);
+    localparam integer XW = (W > 1) ? $clog2(W) : 1;
+    localparam integer YW = (H > 1) ? $clog2(H) : 1;
+    localparam integer CW = $clog2(DEPTH + 2);
+
+    initial begin
+        if (BURST < 1 || DEPTH < BURST) begin
+            $display("rgb565_avmm_writer: need 1 <= BURST=%0d <= DEPTH=%0d",
+                     BURST, DEPTH);
+            $finish;
+        end
+    end
+
+    wire [CW-1:0] f_count;
+    wire          f_valid;
+    wire          beat;                // write beat accepted
+
+    // Room for the output register's word too (count <= DEPTH+1)
+    assign s_axis_tready = (f_count <= DEPTH);
+
+    rgb565_fifo #(
+        .DW(16),
+        .DEPTH(DEPTH)
+    ) fifo (
+        .clk(clk),
+        .rst(rst),
+        .d(s_axis_tdata),
+        .d_valid(s_axis_tvalid && s_axis_tready),
+        .q(avm_writedata),
+        .q_valid(f_valid),
+        .q_ready(beat),
+        .count(f_count)
+    );
+
+    reg              busy;             // frame in progress
+    reg              in_burst;
+    reg [BCW-1:0]    b_left;           // beats left in this burst
+    reg [XW-1:0]     c_x;              // column of the next burst
+    reg [YW-1:0]     c_y;
+    reg [ADDR_W-1:0] c_row;
+
+    wire [XW:0]    c_left = W - c_x;
+    wire [31:0]    c_len32 = (c_left > BURST) ? BURST : c_left;
+    wire [BCW-1:0] c_len = c_len32[BCW-1:0];
+    wire last_burst = (c_y == H-1) && (c_left <= BURST);
+
+    reg last_open;                     // the open burst ends the frame
+
+    assign avm_write = in_burst;
+    assign beat      = in_burst && !avm_waitrequest;
+    wire burst_end   = beat && (b_left == 1);
+
+    // The burst's words all have to be in the FIFO before it opens
+    // (besides the one leaving on this clock), so f_valid stays high
+    // for every beat. The next burst opens on the last beat of the
+    // current one, keeping the writer at one word per clock
+    wire open_burst = busy && !(in_burst && last_open) &&
+                      (!in_burst || burst_end) &&
+                      (f_count >= c_len + (in_burst ? 1 : 0));
+
+    always @(posedge clk) begin
+        if (rst) begin
+            busy <= 0; in_burst <= 0; b_left <= 0;
+            c_x <= 0; c_y <= 0; c_row <= 0;
+            avm_address <= 0; avm_burstcount <= 0;
+            last_open <= 0;
+            done <= 0;
+        end else begin
+            done <= 0;
+            if (start && !busy) begin
+                busy <= 1;
+                c_x <= 0; c_y <= 0; c_row <= base;
+                last_open <= 0;
+            end
+
+            if (beat) begin
+                b_left <= b_left - 1;
+                if (burst_end) begin
+                    in_burst <= 0;
+                    if (last_open) begin
+                        busy <= 0;
+                        done <= 1;
+                    end
+                end
+            end
+
+            // After the beat update: a burst opening on the last beat
+            // of the previous one wins
+            if (open_burst) begin
+                in_burst       <= 1;
+                b_left         <= c_len;
+                avm_address    <= c_row + 2*c_x;
+                avm_burstcount <= c_len;
+                last_open      <= last_burst;
+                if (c_left > BURST) begin
+                    c_x <= c_x + BURST;
+                end else begin
+                    c_x <= 0;
+                    c_row <= c_row + STRIDE;
+                    c_y <= (c_y == H-1) ? 0 : c_y + 1;
+                end
+            end
+        end
+    end
+endmodule
+
+
+// ------------------------------------------------------------
+// Reader -> blur -> writer
+// ------------------------------------------------------------
+module gaussian_blur_rgb565_avmm #(
+    parameter integer W      = 320,
+    parameter integer H      = 240,
+    parameter integer STRIDE = 2*W,
+    parameter integer BURST  = 32,
+    parameter integer DEPTH  = 512,
+    parameter integer ADDR_W = 32,
+    parameter integer BCW    = $clog2(BURST + 1)  // derived
+)(
+    input  wire              clk,
+    input  wire              rst,
+    input  wire              start,
+    input  wire [ADDR_W-1:0] src_base,
+    input  wire [ADDR_W-1:0] dst_base,
+    output wire              done,
+
+    // Avalon-MM read master (source frame)
+    output wire [ADDR_W-1:0] rd_address,
+    output wire              rd_read,
+    output wire [BCW-1:0]    rd_burstcount,
+    input  wire              rd_waitrequest,
+    input  wire [15:0]       rd_readdata,
+    input  wire              rd_readdatavalid,
+
+    // Avalon-MM write master (result frame)
+    output wire [ADDR_W-1:0] wr_address,
+    output wire              wr_write,
+    output wire [BCW-1:0]    wr_burstcount,
+    output wire [15:0]       wr_writedata,
+    input  wire              wr_waitrequest
+);
+    wire [15:0] a_data, b_data;
+    wire        a_valid, a_ready, a_user, a_last;
+    wire        b_valid, b_ready, b_user, b_last;
+
+    rgb565_avmm_reader #(
+        .W(W), .H(H), .STRIDE(STRIDE), .BURST(BURST), .DEPTH(DEPTH),
+        .ADDR_W(ADDR_W)
+    ) reader (
+        .clk(clk),
+        .rst(rst),
+        .start(start),
+        .base(src_base),
+        .avm_address(rd_address),
+        .avm_read(rd_read),
+        .avm_burstcount(rd_burstcount),
+        .avm_waitrequest(rd_waitrequest),
+        .avm_readdata(rd_readdata),
+        .avm_readdatavalid(rd_readdatavalid),
+        .m_axis_tdata(a_data),
+        .m_axis_tvalid(a_valid),
+        .m_axis_tready(a_ready),
+        .m_axis_tuser(a_user),
+        .m_axis_tlast(a_last)
+    );
+
+    gaussian_blur_rgb565_axis #(
+        .W(W),
+        .H(H)
+    ) core (
+        .clk(clk),
+        .rst(rst),
+        .s_axis_tdata(a_data),
+        .s_axis_tvalid(a_valid),
+        .s_axis_tready(a_ready),
+        .s_axis_tuser(a_user),
+        .s_axis_tlast(a_last),
+        .m_axis_tdata(b_data),
+        .m_axis_tvalid(b_valid),
+        .m_axis_tready(b_ready),
+        .m_axis_tuser(b_user),
+        .m_axis_tlast(b_last)
+    );
+
+    rgb565_avmm_writer #(
+        .W(W), .H(H), .STRIDE(STRIDE), .BURST(BURST), .DEPTH(DEPTH),
+        .ADDR_W(ADDR_W)
+    ) writer (
+        .clk(clk),
+        .rst(rst),
+        .start(start),
+        .base(dst_base),
+        .done(done),
+        .s_axis_tdata(b_data),
+        .s_axis_tvalid(b_valid),
+        .s_axis_tready(b_ready),
+        .avm_address(wr_address),
+        .avm_write(wr_write),
+        .avm_burstcount(wr_burstcount),
+        .avm_writedata(wr_writedata),
+        .avm_waitrequest(wr_waitrequest)
+    );
+
+endmodule
+
+
+// ------------------------------------------------------------
+// Testbench: one memory model serves both masters with a fixed
+// read latency and random waitrequest; runs one frame from
+// output.hex and writes blurred.hex
+// ------------------------------------------------------------
+module tb_gaussian_blur_avmm;
+
+    reg clk = 0;
+    reg rst = 1;
+    reg start = 0;
+    wire done;
+
+    // ModelSim-friendly: avoid "localparam string"
+    localparam INFILE  = "output.hex";
+    localparam OUTFILE = "blurred.hex";
+
+    parameter integer W       = 320;
+    parameter integer H       = 240;
+    parameter integer BURST   = 32;
+    parameter integer DEPTH   = 128;
+    parameter integer LATENCY = 40;   // read command to first data
+    parameter integer STALL   = 10;   // % of cycles with waitrequest
+    localparam integer N   = W*H;
+    localparam integer BCW = $clog2(BURST + 1);
+    localparam [31:0] SRC  = 32'h0000_0000;
+    localparam [31:0] DST  = 32'h0010_0000;   // word index N..
+
+    reg [15:0] frame_buffer [0:N-1];
+    reg [15:0] blur_buffer  [0:N-1];
+    initial begin
+        $readmemh(INFILE, frame_buffer);
+    end
+
+    wire [31:0]    rd_address, wr_address;
+    wire           rd_read, wr_write;
+    wire [BCW-1:0] rd_burstcount, wr_burstcount;
+    wire [15:0]    wr_writedata;
+    reg            rd_waitrequest = 0, wr_waitrequest = 0;
+    reg  [15:0]    rd_readdata = 0;
+    reg            rd_readdatavalid = 0;
+
+    gaussian_blur_rgb565_avmm #(
+        .W(W),
+        .H(H),
+        .BURST(BURST),
+        .DEPTH(DEPTH)
+    ) dut (
+        .clk(clk),
+        .rst(rst),
+        .start(start),
+        .src_base(SRC),
+        .dst_base(DST),
+        .done(done),
+        .rd_address(rd_address),
+        .rd_read(rd_read),
+        .rd_burstcount(rd_burstcount),
+        .rd_waitrequest(rd_waitrequest),
+        .rd_readdata(rd_readdata),
+        .rd_readdatavalid(rd_readdatavalid),
+        .wr_address(wr_address),
+        .wr_write(wr_write),
+        .wr_burstcount(wr_burstcount),
+        .wr_writedata(wr_writedata),
+        .wr_waitrequest(wr_waitrequest)
+    );
+
+    always #5 clk = ~clk; // 100 MHz
+
+    // Avalon-MM slave model: accepted read bursts queue up and are
+    // returned LATENCY clocks later, one beat per clock
+    localparam integer QD = 64;
+    reg [31:0] q_addr [0:QD-1];
+    reg [31:0] q_len  [0:QD-1];
+    reg [63:0] q_due  [0:QD-1];
+    integer q_head = 0, q_tail = 0;
+    integer beat_n = 0;
+    integer w_left = 0;
+    reg [31:0] w_addr = 0;
+    reg [63:0] now = 0;
+
+    always @(posedge clk) begin
+        now <= now + 1;
+        rd_waitrequest <= ($urandom % 100) < STALL;
+        wr_waitrequest <= ($urandom % 100) < STALL;
+
+        if (rd_read && !rd_waitrequest) begin
+            q_addr[q_tail % QD] <= rd_address;
+            q_len[q_tail % QD]  <= rd_burstcount;
+            q_due[q_tail % QD]  <= now + LATENCY;
+            q_tail <= q_tail + 1;
+        end
+
+        rd_readdatavalid <= 0;
+        if (q_head != q_tail && q_due[q_head % QD] <= now) begin
+            rd_readdata      <= frame_buffer[(q_addr[q_head % QD] - SRC) / 2 + beat_n];
+            rd_readdatavalid <= 1;
+            if (beat_n == q_len[q_head % QD] - 1) begin
+                beat_n <= 0;
+                q_head <= q_head + 1;
+            end else begin
+                beat_n <= beat_n + 1;
+            end
+        end
+
+        if (wr_write && !wr_waitrequest) begin
+            if (w_left == 0) begin
+                blur_buffer[(wr_address - DST) / 2] <= wr_writedata;
+                w_addr <= wr_address + 2;
+                w_left <= wr_burstcount - 1;
+            end else begin
+                blur_buffer[(w_addr - DST) / 2] <= wr_writedata;
+                w_addr <= w_addr + 2;
+                w_left <= w_left - 1;
+            end
+        end
+    end
+
+    integer cycles = 0;
+    always @(posedge clk) if (!rst) cycles <= cycles + 1;
+
+    initial begin
+        #30 rst = 0;
+
+        #20 start = 1;
+        #10 start = 0;
+
+        wait(done);
+        @(posedge clk);
+
+        $writememh(OUTFILE, blur_buffer);
+
+        $display("Blur complete! Wrote %s (%0d cycles, %0d.%02d pixels/clock)",
+                 OUTFILE, cycles, N / cycles, (N * 100 / cycles) % 100);
+        #20 $finish;
+    end
+
+endmodule
@@ -0,0 +1,340 @@
+// ============================================================
+// Gaussian Blur (3x3), AXI4-Stream RGB565 video in and out
+// - Same arithmetic as gaussian_blur_rgb565_320x240 (gs.v): border
+//   pixels pass through, interior pixels get the 1-2-1 / 2-4-2 / 1-2-1
+//   kernel, >>4 per channel; bit-exact with gauss_blur_rgb565()
+// - No frame buffers: only the two W-entry line buffers
+// - Video convention: tuser = start of frame (first pixel),
+//   tlast = end of line (last pixel of each row)
+// Notes:
+//  - Input beats before the first tuser are dropped, so the core locks
+//    onto the next frame after reset. Line length is fixed by W;
+//    s_axis_tlast is not checked
+//  - Output pixel (qx,qy) leaves once input (qx+1,qy+1) has arrived,
+//    so latency is W+1 pixels plus 3 clocks
+//  - Free-running: if the next frame's SOF beat is waiting when the
+//    last pixel of a frame has been taken, the new frame streams in
+//    with no idle cycles and its first W+1 steps emit the previous
+//    frame's tail (last row, all border). Otherwise the core flushes
+//    the final W+1 outputs itself, then waits for the next tuser
+//  - No per-frame reset of line1/line2 or the window: rows 0/1 of a
+//    frame only ever reach border outputs, so stale contents from the
+//    previous frame never show up
+//  - One global clock enable, ce = !m_axis_tvalid || m_axis_tready,
+//    stalls every stage together, so backpressure never drops data.
+//    s_axis_tvalid gaps turn into bubbles that do not shift the window
+//  - s_axis_tready depends combinationally on m_axis_tready (through ce)
+//  - 1 pixel per clock when both sides are ready
+// ============================================================
+
+`timescale 1ns/1ps
+
+module gaussian_blur_rgb565_axis #(
+    parameter integer W = 320,
+    parameter integer H = 240
+)(
+    input  wire        clk,
+    input  wire        rst,
+
+    // Slave: raw frame in
+    input  wire [15:0] s_axis_tdata,
+    input  wire        s_axis_tvalid,
+    output wire        s_axis_tready,
+    input  wire        s_axis_tuser,   // SOF
+    input  wire        s_axis_tlast,   // EOL (unused)
+
+    // Master: blurred frame out
+    output reg  [15:0] m_axis_tdata,
+    output reg         m_axis_tvalid,
+    input  wire        m_axis_tready,
+    output reg         m_axis_tuser,   // SOF
+    output reg         m_axis_tlast    // EOL
+);
+    // Scan positions run to (0,H+1): N input pixels plus W+1 flush steps
+    localparam integer XW = (W > 1) ? $clog2(W) : 1;
+    localparam integer YW = $clog2(H + 2);
+
+    // Scan limits sized to x/y, so compares and muxes stay width-clean
+    localparam integer X_LAST_I = W - 1;
+    localparam integer Y_LAST_I = H - 1;
+    localparam integer Y_M2_I   = H - 2;
+    localparam integer Y_END_I  = H + 1;
+    localparam [XW-1:0] X_LAST = X_LAST_I[XW-1:0];  // last column
+    localparam [YW-1:0] Y_LAST = Y_LAST_I[YW-1:0];  // last row
+    localparam [YW-1:0] Y_M2   = Y_M2_I[YW-1:0];    // row wrap, -2 mod H
+    localparam [YW-1:0] Y_H    = H[YW-1:0];         // first flush row
+    localparam [YW-1:0] Y_END  = Y_END_I[YW-1:0];   // last flush row
+
+    // ----------------------------
+    // Two line buffers (previous 2 rows)
+    // ----------------------------
+    reg [15:0] line1 [0:W-1];  // row y-1
+    reg [15:0] line2 [0:W-1];  // row y-2
+
+    // Global clock enable: the output register is free or draining
+    wire ce = !m_axis_tvalid || m_axis_tready;
+
+    // Stage 0: scan position of the next step
+    reg [XW-1:0] x;
+    reg [YW-1:0] y;
+    reg          in_frame;  // locked onto a frame, taking input pixels
+    reg          flushing;  // input done, emitting the last W+1 outputs
+    reg          tail_pending;  // previous frame's tail still to emit
+
+    // First flush step: an SOF beat here starts the next frame in
+    // place of the flush (the positions line up exactly)
+    wire at_flush_start = flushing && (x == 0) && (y == Y_H);
+    wire merge          = at_flush_start && s_axis_tvalid && s_axis_tuser;
+
+    // When idle only an SOF beat starts a frame; other beats are dropped
+    wire take_in    = (!flushing && s_axis_tvalid && (in_frame || s_axis_tuser)) ||
+                      merge;
+    wire step       = ce && (take_in || flushing);
+    wire last_in    = (x == X_LAST) && (y == Y_LAST);
+    wire last_flush = (x == 0) && (y == Y_END);
+
+    assign s_axis_tready = ce && (!flushing || (at_flush_start && s_axis_tuser));
+
+    // Stage 1: pixel at (x_d,y_d) and the two pixels above it
+    reg [XW-1:0] x_d;
+    reg [YW-1:0] y_d;
+    reg          v_d;
+    reg          tail_d;    // step emits the previous frame's tail
+    reg [15:0]   p_in;
+    reg [15:0]   p_mid;
+    reg [15:0]   p_top;
+
+    // Stage 2: window column 2 holds (x_dd,y_dd); centre is the pixel
+    // one step behind it in each direction, i.e. W+1 positions back
+    reg [XW-1:0] x_dd;
+    reg [YW-1:0] y_dd;
+    reg          v_dd;
+    reg          tail_dd;
+
+    // 3x3 window shift regs
+    reg [15:0] r0_0, r0_1, r0_2;
+    reg [15:0] r1_0, r1_1, r1_2;
+    reg [15:0] r2_0, r2_1, r2_2;
+
+    // Channel extract helpers, zero-extended to the 10-bit sum width
+    function automatic [9:0] R5(input [15:0] p); begin R5 = {5'd0, p[15:11]}; end endfunction
+    function automatic [9:0] G6(input [15:0] p); begin G6 = {4'd0, p[10:5]};  end endfunction
+    function automatic [9:0] B5(input [15:0] p); begin B5 = {5'd0, p[4:0]};   end endfunction
+
+    // Gaussian weights:
+    // 1 2 1
+    // 2 4 2   all / 16
+    // 1 2 1
+    wire [9:0] sumR =
+        (R5(r0_0)) + (R5(r0_1)<<1) + (R5(r0_2)) +
+        (R5(r1_0)<<1) + (R5(r1_1)<<2) + (R5(r1_2)<<1) +
+        (R5(r2_0)) + (R5(r2_1)<<1) + (R5(r2_2));
+
+    wire [9:0] sumG =
+        (G6(r0_0)) + (G6(r0_1)<<1) + (G6(r0_2)) +
+        (G6(r1_0)<<1) + (G6(r1_1)<<2) + (G6(r1_2)<<1) +
+        (G6(r2_0)) + (G6(r2_1)<<1) + (G6(r2_2));
+
+    wire [9:0] sumB =
+        (B5(r0_0)) + (B5(r0_1)<<1) + (B5(r0_2)) +
+        (B5(r1_0)<<1) + (B5(r1_1)<<2) + (B5(r1_2)<<1) +
+        (B5(r2_0)) + (B5(r2_1)<<1) + (B5(r2_2));
+
+    wire [15:0] blurred_pixel = {sumR[8:4], sumG[9:4], sumB[8:4]};  // /16
+
+    // Output pixel for the window at (x_dd,y_dd): centre (x_dd-1,y_dd-1),
+    // or the previous row's last pixel when x_dd == 0. Rows wrap
+    // modulo H into the previous frame for tail steps.
+    wire          emit  = (y_dd >= 2) || (y_dd == 1 && x_dd != 0) || tail_dd;
+    wire [XW-1:0] q_x   = (x_dd == 0) ? X_LAST : x_dd - 1;
+    wire [YW-1:0] q_y   = (x_dd == 0) ? ((y_dd >= 2) ? y_dd - 2 : y_dd + Y_M2)
+                                      : ((y_dd >= 1) ? y_dd - 1 : Y_LAST);
+    wire          q_brd = (q_x == 0) || (q_x == X_LAST) ||
+                          (q_y == 0) || (q_y == Y_LAST);
+
+    always @(posedge clk) begin
+        if (rst) begin
+            x <= 0; y <= 0;
+            in_frame <= 0; flushing <= 0; tail_pending <= 0;
+            x_d <= 0; y_d <= 0; v_d <= 0; tail_d <= 0;
+            x_dd <= 0; y_dd <= 0; v_dd <= 0; tail_dd <= 0;
+            p_in <= 0; p_mid <= 0; p_top <= 0;
+
+            r0_0<=0; r0_1<=0; r0_2<=0;
+            r1_0<=0; r1_1<=0; r1_2<=0;
+            r2_0<=0; r2_1<=0; r2_2<=0;
+
+            m_axis_tdata <= 0; m_axis_tvalid <= 0;
+            m_axis_tuser <= 0; m_axis_tlast  <= 0;
+        end else if (ce) begin
+            // ---------------- Stage 0 -> 1 ----------------
+            v_d <= step;
+
+            if (step) begin
+                // Flush steps feed zeros; they only reach border outputs
+                p_in  <= (flushing && !merge) ? 16'h0000 : s_axis_tdata;
+                p_mid <= line1[x];
+                p_top <= line2[x];
+
+                x_d    <= x;
+                y_d    <= merge ? 0 : y;
+                tail_d <= merge || (tail_pending && (y == 0 || (y == 1 && x == 0)));
+                if (tail_pending && y == 1 && x == 0)
+                    tail_pending <= 0;
+
+                // Advance scan
+                if (x == X_LAST) begin
+                    x <= 0;
+                    y <= y + 1;
+                end else begin
+                    x <= x + 1;
+                end
+
+                if (!flushing)
+                    in_frame <= 1;
+                if (!flushing && last_in) begin
+                    in_frame <= 0;
+                    flushing <= 1;
+                end
+                if (flushing && last_flush) begin
+                    flushing <= 0;
+                    x <= 0;
+                    y <= 0;
+                end
+                if (merge) begin
+                    // Position (0,H) of the old frame is (0,0) of the new
+                    in_frame     <= 1;
+                    flushing     <= 0;
+                    tail_pending <= 1;
+                    y            <= 0;
+                end
+            end
+
+            // ---------------- Stage 1 -> 2 ----------------
+            v_dd <= v_d;
+
+            if (v_d) begin
+                // Shift 3x3 window, insert newest column on the right
+                r0_0 <= r0_1;  r0_1 <= r0_2;  r0_2 <= p_top;
+                r1_0 <= r1_1;  r1_1 <= r1_2;  r1_2 <= p_mid;
+                r2_0 <= r2_1;  r2_1 <= r2_2;  r2_2 <= p_in;
+
+                // Update line buffers at the column p_in came from
+                // (stage 0 is already reading the next column)
+                line2[x_d] <= p_mid;
+                line1[x_d] <= p_in;
+
+                x_dd    <= x_d;
+                y_dd    <= y_d;
+                tail_dd <= tail_d;
+            end
+
+            // ---------------- Stage 2: output register ----------------
+            m_axis_tvalid <= v_dd && emit;
+            if (v_dd && emit) begin
+                m_axis_tdata <= q_brd ? r1_1 : blurred_pixel;
+                m_axis_tuser <= (q_x == 0) && (q_y == 0);
+                m_axis_tlast <= (q_x == X_LAST);
+            end
+        end
+    end
+
+endmodule
+
+
+// ------------------------------------------------------------
+// Testbench: streams output.hex through the core FRAMES times
+// back-to-back, checks every frame's output against the first
+// and writes blurred.hex. GAPS=1 adds random tvalid/tready gaps;
+// GAPS=0 measures free-running throughput.
+// ------------------------------------------------------------
+module tb_gaussian_blur_axis;
+
+    reg clk = 0;
+    reg rst = 1;
+
+    // ModelSim-friendly: avoid "localparam string"
+    localparam INFILE  = "output.hex";
+    localparam OUTFILE = "blurred.hex";
+
+    parameter integer W = 320;
+    parameter integer H = 240;
+    parameter integer FRAMES = 2;
+    parameter integer GAPS = 1;
+    localparam integer N = W*H;
+
+    reg [15:0] frame_buffer [0:N-1];
+    reg [15:0] blur_buffer  [0:N-1];
+    initial begin
+        $readmemh(INFILE, frame_buffer);
+    end
+
+    integer in_idx  = 0;  // beats sent, over all frames
+    integer out_idx = 0;  // beats received, over all frames
+    integer cycles  = 0;
+    integer errors  = 0;
+
+    reg  s_valid = 0;
+    reg  m_ready = 0;
+    wire s_ready;
+    wire [15:0] m_data;
+    wire m_valid, m_user, m_last;
+
+    gaussian_blur_rgb565_axis #(
+        .W(W),
+        .H(H)
+    ) dut (
+        .clk(clk),
+        .rst(rst),
+        .s_axis_tdata(frame_buffer[in_idx % N]),
+        .s_axis_tvalid(s_valid),
+        .s_axis_tready(s_ready),
+        .s_axis_tuser(in_idx % N == 0),
+        .s_axis_tlast(in_idx % W == W-1),
+        .m_axis_tdata(m_data),
+        .m_axis_tvalid(m_valid),
+        .m_axis_tready(m_ready),
+        .m_axis_tuser(m_user),
+        .m_axis_tlast(m_last)
+    );
+
+    always #5 clk = ~clk; // 100 MHz
+
+    always @(posedge clk) begin
+        if (!rst) begin
+            cycles <= cycles + 1;
+            if (s_valid && s_ready) in_idx <= in_idx + 1;
+            if (m_valid && m_ready) begin
+                if (m_user != (out_idx % N == 0) || m_last != (out_idx % W == W-1)) begin
+                    $display("Sideband mismatch at beat %0d", out_idx);
+                    errors = errors + 1;
+                end
+                if (out_idx < N)
+                    blur_buffer[out_idx] <= m_data;
+                else if (blur_buffer[out_idx % N] !== m_data) begin
+                    $display("Frame %0d differs at pixel %0d", out_idx / N, out_idx % N);
+                    errors = errors + 1;
+                end
+                out_idx <= out_idx + 1;
+            end
+            // ~75% duty on both sides exercises stalls and bubbles
+            s_valid <= (in_idx + (s_valid && s_ready) < FRAMES*N) &&
+                       (!GAPS || $random % 4 != 0);
+            m_ready <= (!GAPS || $random % 4 != 0);
+        end
+    end
+
+    initial begin
+        #30 rst = 0;
+
+        wait(out_idx == FRAMES*N);
+        @(posedge clk);
+
+        $writememh(OUTFILE, blur_buffer);
+
+        $display("Blur complete! Wrote %s (%0d frames, %0d cycles, %0d errors)",
+                 OUTFILE, FRAMES, cycles, errors);
+        #20 $finish;
+    end
+
+endmodule
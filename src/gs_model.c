@@ -0,0 +1,247 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_cache.h"
+#include "frame_io.h"
+#include "parallel.h"
+#include "planar.h"
+
+// -------------------------------------------------------
+// CPU stand-in for the simulation run: reads the frame
+// tb_gaussian_blur would $readmemh, blurs it with the
+// golden model and writes what $writememh would produce.
+//
+// Usage: gs_model [--threads=N] [--size=WxH]
+//                 [--kernel=c0,..,c2R | --binomial=R |
+//                  --sigma=S [--radius=R]]
+//                 [--border=pass|replicate|mirror|zero]
+//                 [--strip=N] [--planar] [--cache=DIR]
+//                 [input.hex|input.bin|input.raw]
+//                 [output.hex|output.bin|output.raw]
+//        (defaults: output.hex blurred.hex, as in the testbench)
+// Geometry comes from the input header; --size (default
+// 320x240) covers headerless input. The output header
+// carries the same geometry. The default kernel is the
+// 3x3 1-2-1 of gs.v; the kernel options model gs_sep.v
+// (--sigma taps are scaled to sum 256, radius ceil(2S)).
+// --border sets the edge handling (gs.v BORDER parameter);
+// pass copies edge pixels, the others blur them too.
+// --strip blurs N-column vertical strips one at a time, as
+// gs_tiled.v does; the result is the same as untiled.
+// --planar runs the default 3x3 blur on R5/G6/B5 planes
+// (planar.h), again with the same result.
+// --cache reuses the output of an earlier run on the same
+// input bytes with the same --size and kernel settings (see
+// frame_cache.h), so rerunning a sequence only blurs the
+// frames that changed.
+// Build: cc -O2 -o gs_model gs_model.c -pthread -lm
+// -------------------------------------------------------
+
+// Cache key settings; --threads, --strip and --planar give
+// the same frame and are left out
+typedef struct {
+  char tool[8];
+  int32_t in_fmt;
+  int32_t width, height;  // --size, for headerless input
+  int32_t radius, shift, border;
+  uint16_t coeff[GAUSS_KERNEL_MAX_TAPS];
+} BlurKeyConfig;
+
+static void blur_key_config(BlurKeyConfig *k, FrameFormat in_fmt, int width,
+                            int height, const GaussKernel *kernel) {
+  memset(k, 0, sizeof(*k));
+  memcpy(k->tool, "gs_model", 8);
+  k->in_fmt = (int32_t)in_fmt;
+  k->width = width;
+  k->height = height;
+  k->radius = kernel->radius;
+  k->shift = kernel->shift;
+  k->border = (int32_t)kernel->border;
+  memcpy(k->coeff, kernel->coeff,
+         (size_t)gauss_kernel_taps(kernel) * sizeof(uint16_t));
+}
+
+int main(int argc, char *argv[]) {
+  const char *in_path = "output.hex";
+  const char *out_path = "blurred.hex";
+  int nthreads = 1;
+  int width = FRAME_DEFAULT_WIDTH;
+  int height = FRAME_DEFAULT_HEIGHT;
+  GaussKernel kernel;
+  gauss_kernel_default(&kernel);
+  GaussBorder border = GAUSS_BORDER_PASS;
+  double sigma = 0.0;
+  int radius = 0;
+  int strip = 0;
+  int planar = 0;
+  const char *cache_dir = NULL;
+  int npos = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--threads=", 10) == 0) {
+      nthreads = atoi(argv[i] + 10);
+    } else if (strncmp(argv[i], "--size=", 7) == 0) {
+      if (parse_geometry(argv[i] + 7, &width, &height) != 0) {
+        fprintf(stderr, "Bad --size (expected WxH): %s\n", argv[i] + 7);
+        return 1;
+      }
+    } else if (strncmp(argv[i], "--kernel=", 9) == 0) {
+      if (gauss_kernel_parse(&kernel, argv[i] + 9) != 0) {
+        fprintf(stderr,
+                "Bad --kernel (odd tap count, sum a power of two): %s\n",
+                argv[i] + 9);
+        return 1;
+      }
+    } else if (strncmp(argv[i], "--binomial=", 11) == 0) {
+      if (gauss_kernel_binomial(&kernel, atoi(argv[i] + 11)) != 0) {
+        fprintf(stderr, "Bad --binomial radius (1..%d): %s\n",
+                GAUSS_KERNEL_MAX_SHIFT / 2, argv[i] + 11);
+        return 1;
+      }
+    } else if (strncmp(argv[i], "--sigma=", 8) == 0) {
+      sigma = atof(argv[i] + 8);
+    } else if (strncmp(argv[i], "--radius=", 9) == 0) {
+      radius = atoi(argv[i] + 9);
+    } else if (strncmp(argv[i], "--border=", 9) == 0) {
+      if (gauss_border_parse(argv[i] + 9, &border) != 0) {
+        fprintf(stderr, "Bad --border (pass|replicate|mirror|zero): %s\n",
+                argv[i] + 9);
+        return 1;
+      }
+    } else if (strncmp(argv[i], "--strip=", 8) == 0) {
+      strip = atoi(argv[i] + 8);
+    } else if (strcmp(argv[i], "--planar") == 0) {
+      planar = 1;
+    } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+      cache_dir = argv[i] + 8;
+    } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+      fprintf(stderr, "Unknown option: %s\n", argv[i]);
+      return 1;
+    } else if (npos == 0) {
+      in_path = argv[i];
+      npos++;
+    } else if (npos == 1) {
+      out_path = argv[i];
+      npos++;
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--threads=N] [--size=WxH] [input] [output]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (sigma > 0.0) {
+    if (radius <= 0) radius = (int)ceil(2.0 * sigma);
+    if (gauss_kernel_from_sigma(&kernel, radius, sigma, 8) != 0) {
+      fprintf(stderr, "Bad --sigma/--radius (radius 1..%d)\n",
+              GAUSS_KERNEL_MAX_RADIUS);
+      return 1;
+    }
+  }
+  kernel.border = border;
+  if (strip != 0 && strip <= 2 * kernel.radius) {
+    fprintf(stderr, "Bad --strip (more than %d columns): %d\n",
+            2 * kernel.radius, strip);
+    return 1;
+  }
+  if (planar && (strip || !gauss_kernel_is_default(&kernel))) {
+    fprintf(stderr, "--planar only runs the default 3x3 kernel, untiled\n");
+    return 1;
+  }
+  if (!gauss_kernel_is_default(&kernel)) {
+    printf("Kernel %dx%d:", gauss_kernel_taps(&kernel),
+           gauss_kernel_taps(&kernel));
+    for (int i = 0; i < gauss_kernel_taps(&kernel); i++)
+      printf(" %u", kernel.coeff[i]);
+    printf(" (>> %d)\n", 2 * kernel.shift);
+  }
+  FrameFormat in_fmt = frame_format_from_path(in_path);
+  FrameFormat out_fmt = frame_format_from_path(out_path);
+  FrameCache cache;
+  if (cache_dir && frame_cache_open(&cache, cache_dir) != 0) return 1;
+
+  FILE *in = fopen(in_path, frame_format_is_binary(in_fmt) ? "rb" : "r");
+  if (!in) {
+    perror(in_path);
+    return 1;
+  }
+  uint64_t key = 0;
+  if (cache_dir) {
+    BlurKeyConfig k;
+    blur_key_config(&k, in_fmt, width, height, &kernel);
+    if (frame_cache_key_file(in, &k, sizeof(k), &key) != 0) {
+      fprintf(stderr, "Error: failed reading %s\n", in_path);
+      fclose(in);
+      return 1;
+    }
+    if (frame_cache_has(&cache, key, frame_format_ext(out_fmt))) {
+      fclose(in);
+      if (frame_cache_fetch(&cache, key, frame_format_ext(out_fmt), out_path,
+                            NULL) != 0)
+        return 1;
+      printf("Unchanged; copied %s from %s/%016llx%s\n", out_path,
+             cache.dir, (unsigned long long)key, frame_format_ext(out_fmt));
+      return 0;
+    }
+  }
+  read_frame_header(in, in_fmt, &width, &height);
+  size_t total_pixels = (size_t)width * height;
+
+  uint16_t *frame = (uint16_t *)malloc(total_pixels * sizeof(uint16_t));
+  if (!frame) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    fclose(in);
+    return 1;
+  }
+
+  size_t got = read_frame_pixels(in, in_fmt, frame, total_pixels);
+  fclose(in);
+  if (got < total_pixels) {
+    fprintf(stderr,
+            "Warning: %s has %zu of %zu pixels; padding with the last\n",
+            in_path, got, total_pixels);
+    uint16_t last = got ? frame[got - 1] : 0;
+    while (got < total_pixels) frame[got++] = last;
+  }
+
+  ThreadPool *pool = thread_pool_create(nthreads);
+  int blur_err;
+  if (planar)
+    blur_err = gauss_blur_rgb565_planar(frame, frame, width, height);
+  else if (strip)
+    blur_err = gauss_blur_rgb565_strips_mt(pool, NULL, &kernel, frame, frame,
+                                           width, height, strip);
+  else
+    blur_err = gauss_blur_rgb565_kernel_mt(pool, NULL, &kernel, frame, frame,
+                                           width, height);
+  thread_pool_destroy(pool);
+  if (blur_err != 0) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    free(frame);
+    return 1;
+  }
+
+  FILE *out = fopen(out_path, frame_format_is_binary(out_fmt) ? "wb" : "w");
+  if (!out) {
+    perror(out_path);
+    free(frame);
+    return 1;
+  }
+  int err = write_frame_header(out, out_fmt, width, height);
+  if (!err) err = write_frame_pixels(out, out_fmt, frame, total_pixels);
+  if (fclose(out) != 0) err = -1;
+  free(frame);
+  if (err) {
+    fprintf(stderr, "Error: failed writing %s\n", out_path);
+    return 1;
+  }
+
+  // A failed store only costs the next run a blur
+  if (cache_dir)
+    frame_cache_store(&cache, key, frame_format_ext(out_fmt), out_path);
+  printf("Blur complete! Wrote %s\n", out_path);
+  return 0;
+}
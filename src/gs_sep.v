@@ -0,0 +1,293 @@
+// ============================================================
+// Separable Gaussian Blur ((2R+1)x(2R+1)) for a WxH RGB565 image
+// stored in a HEX file
+// - Same frame-buffer interface and HEX formats as
+//   gaussian_blur_rgb565_320x240 (gs.v)
+// - KERNEL holds the 2R+1 one-dimensional taps, CB bits each, tap 0
+//   in the LSBs; they must sum to 1 << NORM_SHIFT. The 2-D weight is
+//   tap[i]*tap[j] and each channel is >> (2*NORM_SHIFT), truncating
+// - Pixels closer than R to an edge are copied through unchanged
+// Notes:
+//  - Vertical FIR first: one BRAM word per column holds the 2R rows
+//    above (16 bits each), so the line buffers stay 16-bit RGB565;
+//    the 2R+1 vertical sums then feed a horizontal FIR shift register.
+//    That is 2*(2R+1) constant multiplies per channel, not (2R+1)^2
+//  - Same 3-stage pipeline and output address counter as gs.v, but
+//    not its single-write border scheme: blur_buffer keeps two write
+//    ports, the pass-through copy of each input pixel at addr_d and
+//    the interior result at out_addr, which overwrites it. Borders
+//    are pass-through only (no BORDER parameter)
+//  - Bit-exact C golden model: gauss_blur_rgb565_kernel() in
+//    gauss_kernel.h (gs_model --kernel / --binomial / --sigma)
+//  - Defaults: R=2, binomial 1 4 6 4 1 (sigma 1). For sigma 1.5
+//    use R=3, KERNEL={8'd9,8'd28,8'd55,8'd72,8'd55,8'd28,8'd9},
+//    NORM_SHIFT=8 (gs_model --sigma=1.5 prints the taps)
+// ============================================================
+
+`timescale 1ns/1ps
+
+module gaussian_blur_rgb565_sep #(
+    // More ModelSim-friendly than "parameter string"
+    parameter IN_HEX = "output.hex",
+    parameter integer W = 320,
+    parameter integer H = 240,
+    parameter integer R = 2,            // kernel radius
+    parameter integer CB = 8,           // bits per tap
+    parameter integer NORM_SHIFT = 4,   // taps sum to 1 << NORM_SHIFT
+    parameter [CB*(2*R+1)-1:0] KERNEL = {8'd1, 8'd4, 8'd6, 8'd4, 8'd1}
+)(
+    input  wire clk,
+    input  wire rst,
+    input  wire start,
+    output reg  done
+);
+    localparam integer N  = W*H;
+    localparam integer K  = 2*R + 1;
+    localparam integer XW = (W > 1) ? $clog2(W) : 1;
+    localparam integer YW = (H > 1) ? $clog2(H) : 1;
+    localparam integer AW = (N > 1) ? $clog2(N) : 1;
+    localparam integer VW = 6 + NORM_SHIFT;    // vertical sum width
+    localparam integer HW = 6 + 2*NORM_SHIFT;  // 2-D sum width
+
+    // ----------------------------
+    // Input frame buffer (RGB565)
+    // ----------------------------
+    reg [15:0] frame_buffer [0:N-1];
+    initial begin
+        $readmemh(IN_HEX, frame_buffer);
+    end
+
+    // ----------------------------
+    // Output blurred buffer (RGB565)
+    // ----------------------------
+    reg [15:0] blur_buffer [0:N-1];
+
+    // ----------------------------
+    // Line buffers: rows y-1 .. y-2R of one column per word,
+    // row y-1-i in bits [16*i +: 16]
+    // ----------------------------
+    reg [16*2*R-1:0] lines [0:W-1];
+
+    // Scan counters (stage 0: read address)
+    reg [XW-1:0] x;     // 0..W-1
+    reg [YW-1:0] y;     // 0..H-1
+    reg [AW-1:0] addr;  // 0..N-1
+    reg          running;
+
+    // Stage 1: pixel at (x_d,y_d) and the 2R pixels above it
+    reg [XW-1:0]     x_d;
+    reg [YW-1:0]     y_d;
+    reg [AW-1:0]     addr_d;
+    reg              v_d;
+    reg              last_d;
+    reg [15:0]       p_in;
+    reg [16*2*R-1:0] taps;
+
+    // Stage 2: vertical sums of columns x_dd-2R .. x_dd (newest in the
+    // top slot); centre is (x_dd-R, y_dd-R)
+    reg [XW-1:0]   x_dd;
+    reg [YW-1:0]   y_dd;
+    reg            v_dd;
+    reg            last_dd;
+    reg [VW*K-1:0] hsR, hsG, hsB;
+
+    // Set on the edge that performs the final write; done follows it
+    reg            fin;
+
+    // Output address counter: centre of the stage-2 window
+    reg [AW-1:0]   out_addr;
+
+    function automatic [CB-1:0] tap(input integer i);
+        begin tap = KERNEL[CB*i +: CB]; end
+    endfunction
+
+    // Channel extract helpers
+    function automatic [4:0] R5(input [15:0] p); begin R5 = p[15:11]; end endfunction
+    function automatic [5:0] G6(input [15:0] p); begin G6 = p[10:5];  end endfunction
+    function automatic [4:0] B5(input [15:0] p); begin B5 = p[4:0];   end endfunction
+
+    // Column x_d, rows y_d .. y_d-2R: col[16*i +: 16] is row y_d-i,
+    // i.e. vertical offset R-i from the centre row
+    wire [16*K-1:0] col = {taps, p_in};
+
+    // Vertical FIR (stage 1, combinational)
+    reg [VW-1:0] vR, vG, vB;
+    integer vi;
+    always @(*) begin
+        vR = 0; vG = 0; vB = 0;
+        for (vi = 0; vi < K; vi = vi + 1) begin
+            vR = vR + tap(2*R - vi) * R5(col[16*vi +: 16]);
+            vG = vG + tap(2*R - vi) * G6(col[16*vi +: 16]);
+            vB = vB + tap(2*R - vi) * B5(col[16*vi +: 16]);
+        end
+    end
+
+    // Horizontal FIR (stage 2, combinational): slot j is column
+    // x_dd-2R+j, horizontal offset j-R
+    reg [HW-1:0] sR, sG, sB;
+    integer hi;
+    always @(*) begin
+        sR = 0; sG = 0; sB = 0;
+        for (hi = 0; hi < K; hi = hi + 1) begin
+            sR = sR + tap(hi) * hsR[VW*hi +: VW];
+            sG = sG + tap(hi) * hsG[VW*hi +: VW];
+            sB = sB + tap(hi) * hsB[VW*hi +: VW];
+        end
+    end
+
+    wire [4:0] blurR = sR >> (2*NORM_SHIFT);
+    wire [5:0] blurG = sG >> (2*NORM_SHIFT);
+    wire [4:0] blurB = sB >> (2*NORM_SHIFT);
+
+    wire [15:0] blurred_pixel = {blurR, blurG, blurB};
+
+    initial begin : check_params
+        integer ti, tsum;
+        tsum = 0;
+        for (ti = 0; ti < K; ti = ti + 1) tsum = tsum + tap(ti);
+        if (R < 1 || W < K || H < K || tsum != (1 << NORM_SHIFT)) begin
+            $display("gaussian_blur_rgb565_sep: need R>=1, W,H>=2R+1 and taps summing to %0d (got %0d)",
+                     1 << NORM_SHIFT, tsum);
+            $finish;
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rst) begin
+            x <= 0; y <= 0; addr <= 0;
+            x_d <= 0; y_d <= 0; addr_d <= 0;
+            x_dd <= 0; y_dd <= 0;
+            v_d <= 0; v_dd <= 0;
+            last_d <= 0; last_dd <= 0;
+            out_addr <= -(R*W + R);
+            fin <= 0;
+            running <= 0;
+            done <= 0;
+
+            p_in <= 0; taps <= 0;
+            hsR <= 0; hsG <= 0; hsB <= 0;
+
+            // lines needs no reset: rows 0 .. 2R-1 only seed border
+            // outputs, so nothing from a previous frame leaks through
+        end else begin
+            // Pulse done once the final write has landed
+            fin  <= v_dd && last_dd;
+            done <= fin;
+
+            if (start && !running) begin
+                running <= 1;
+                x <= 0; y <= 0; addr <= 0;
+                out_addr <= -(R*W + R);
+            end
+
+            // ---------------- Stage 0 -> 1 ----------------
+            v_d    <= running;
+            last_d <= running && (addr == N-1);
+
+            if (running) begin
+                // Read pixel at (x,y) and the column above it
+                p_in <= frame_buffer[addr];
+                taps <= lines[x];
+
+                x_d    <= x;
+                y_d    <= y;
+                addr_d <= addr;
+
+                // Advance scan
+                if (addr == N-1) begin
+                    running <= 0;
+                end else begin
+                    addr <= addr + 1;
+
+                    if (x == W-1) begin
+                        x <= 0;
+                        y <= y + 1;
+                    end else begin
+                        x <= x + 1;
+                    end
+                end
+            end
+
+            // ---------------- Stage 1 -> 2 ----------------
+            v_dd    <= v_d;
+            last_dd <= v_d && last_d;
+
+            if (v_d) begin
+                // Shift the vertical sums in as the newest column
+                hsR <= {vR, hsR[VW*K-1:VW]};
+                hsG <= {vG, hsG[VW*K-1:VW]};
+                hsB <= {vB, hsB[VW*K-1:VW]};
+
+                // Push p_in into the column, dropping row y-2R
+                // (stage 0 is already reading the next column)
+                lines[x_d] <= col[16*2*R-1:0];
+
+                x_dd <= x_d;
+                y_dd <= y_d;
+
+                // Write port 1: a defined value for every output address,
+                // the pass-through value for border pixels
+                blur_buffer[addr_d] <= p_in;
+            end
+
+            // ---------------- Stage 2: write ----------------
+            // Write port 2: overwrite interior pixels when the window is valid
+            if (v_dd) begin
+                if (x_dd >= 2*R && y_dd >= 2*R)
+                    blur_buffer[out_addr] <= blurred_pixel;
+                out_addr <= out_addr + 1;
+            end
+        end
+    end
+
+endmodule
+
+
+// ------------------------------------------------------------
+// Testbench: runs the separable blur once and writes blurred.hex
+// ------------------------------------------------------------
+module tb_gaussian_blur_sep;
+
+    reg clk = 0;
+    reg rst = 1;
+    reg start = 0;
+    wire done;
+
+    // ModelSim-friendly: avoid "localparam string"
+    localparam INFILE  = "output.hex";
+    localparam OUTFILE = "blurred.hex";
+
+    parameter integer W = 320;
+    parameter integer H = 240;
+
+    gaussian_blur_rgb565_sep #(
+        .IN_HEX(INFILE),
+        .W(W),
+        .H(H)
+    ) dut (
+        .clk(clk),
+        .rst(rst),
+        .start(start),
+        .done(done)
+    );
+
+    always #5 clk = ~clk; // 100 MHz
+
+    initial begin
+        // Reset
+        #30 rst = 0;
+
+        // Start pulse
+        #20 start = 1;
+        #10 start = 0;
+
+        // Wait for completion
+        wait(done);
+
+        $writememh(OUTFILE, dut.blur_buffer);
+
+        $display("Blur complete! Wrote %s", OUTFILE);
+        #20 $finish;
+    end
+
+endmodule
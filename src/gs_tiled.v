@@ -0,0 +1,291 @@
+// ============================================================
+// Gaussian Blur (3x3), tiled into vertical strips, for frames
+// larger than on-chip memory
+// - The frame lives in an external memory (read port rd_*) and the
+//   result goes to another (write port wr_*); on chip there is only
+//   gaussian_blur_rgb565_axis sized to one strip, i.e. two
+//   STRIP-pixel line buffers, whatever W is
+// - Strip k covers source columns x0 .. x0+STRIP-1 of every row,
+//   x0 = min(k*(STRIP-2), W-STRIP): neighbouring strips overlap by
+//   the 1-pixel halo (K/2 for a 3x3 kernel) on each side. Each strip
+//   goes through the core as its own STRIPxH frame; the strip's
+//   first/last columns are the core's border pixels, so they are
+//   only written where they are the frame's own edge (the first
+//   strip's left column, the last strip's right column). Everything
+//   else is an interior output with its real neighbours, so the
+//   stitched result is bit-exact with gaussian_blur_rgb565_320x240
+//   (and gauss_blur_rgb565() / gs_model --strip=STRIP)
+// - The last strip is clamped to end at column W-1, so it may redo
+//   columns of the one before; those writes carry the same values
+// - The core takes the next strip's SOF back-to-back, so a frame
+//   costs about NS*STRIP*H + STRIP clocks for NS strips
+// Notes:
+//  - rd_data must hold its value while rd_en is low (the usual
+//    registered BRAM/SRAM read port). It is used directly as the
+//    core's s_axis_tdata; a read is only issued when the previous
+//    word has been taken, so no skid buffer is needed
+//  - The result port never stalls (m_axis_tready = 1), so writes
+//    are not backpressured
+// ============================================================
+
+`timescale 1ns/1ps
+
+module gaussian_blur_rgb565_tiled #(
+    parameter integer W = 1920,
+    parameter integer H = 1080,
+    // Strip width including the halo columns; 3 <= STRIP <= W
+    parameter integer STRIP = 64,
+    // Frame address width (derived; do not override)
+    parameter integer AW = (W*H > 1) ? $clog2(W*H) : 1
+)(
+    input  wire          clk,
+    input  wire          rst,
+    input  wire          start,
+    output reg           done,
+
+    // Source frame: rd_data = frame[rd_addr] one clock after rd_en
+    output wire [AW-1:0] rd_addr,
+    output wire          rd_en,
+    input  wire [15:0]   rd_data,
+
+    // Result frame
+    output reg  [AW-1:0] wr_addr,
+    output reg           wr_en,
+    output reg  [15:0]   wr_data
+);
+    localparam integer STEP = STRIP - 2;        // new columns per strip
+    localparam integer LAST = W - STRIP;        // x0 of the last strip
+    localparam integer XW   = (W > 1) ? $clog2(W) : 1;
+    localparam integer LW   = $clog2(STRIP);
+    localparam integer YW   = (H > 1) ? $clog2(H) : 1;
+
+    initial begin
+        if (STRIP < 3 || STRIP > W || H < 2) begin
+            $display("gaussian_blur_rgb565_tiled: need 3 <= STRIP=%0d <= W=%0d and H>=2",
+                     STRIP, W);
+            $finish;
+        end
+    end
+
+    // Origin of the strip after the one at x
+    function automatic [XW-1:0] next_x0(input [XW-1:0] x);
+        begin
+            next_x0 = (x + STEP > LAST) ? LAST : x + STEP;
+        end
+    endfunction
+
+    // ----------------------------
+    // Reader: strip-by-strip raster scan of the source frame
+    // ----------------------------
+    reg          rd_busy;
+    reg [XW-1:0] r_x0;     // strip origin
+    reg [LW-1:0] r_x;      // column within the strip
+    reg [YW-1:0] r_y;
+    reg [AW-1:0] r_row;    // r_y*W + r_x0
+
+    // rd_data is the word on offer to the core while hold_v is set
+    reg          hold_v;
+    reg          hold_user;
+    reg          hold_last;
+
+    wire         s_ready;
+    wire         take  = hold_v && s_ready;
+    wire         issue = rd_busy && (!hold_v || take);
+
+    assign rd_en   = issue;
+    assign rd_addr = r_row + r_x;
+
+    // ----------------------------
+    // Strip core: line buffers sized to the strip
+    // ----------------------------
+    wire [15:0] m_data;
+    wire        m_valid, m_user, m_last;
+
+    gaussian_blur_rgb565_axis #(
+        .W(STRIP),
+        .H(H)
+    ) core (
+        .clk(clk),
+        .rst(rst),
+        .s_axis_tdata(rd_data),
+        .s_axis_tvalid(hold_v),
+        .s_axis_tready(s_ready),
+        .s_axis_tuser(hold_user),
+        .s_axis_tlast(hold_last),
+        .m_axis_tdata(m_data),
+        .m_axis_tvalid(m_valid),
+        .m_axis_tready(1'b1),
+        .m_axis_tuser(m_user),
+        .m_axis_tlast(m_last)
+    );
+
+    // ----------------------------
+    // Writer: same scan order as the reader, one strip behind at most
+    // ----------------------------
+    reg          wr_busy;
+    reg [XW-1:0] o_x0;
+    reg [LW-1:0] o_x;
+    reg [YW-1:0] o_y;
+    reg [AW-1:0] o_row;
+
+    // Set on the edge that presents the final write; done follows it
+    reg          fin;
+
+    // Strip borders are kept only where they are the frame's edge
+    wire o_keep = (o_x != 0 && o_x != STRIP-1) ||
+                  (o_x == 0 && o_x0 == 0) ||
+                  (o_x == STRIP-1 && o_x0 == LAST);
+    wire o_last = (o_x == STRIP-1) && (o_y == H-1) && (o_x0 == LAST);
+
+    always @(posedge clk) begin
+        if (rst) begin
+            rd_busy <= 0;
+            r_x0 <= 0; r_x <= 0; r_y <= 0; r_row <= 0;
+            hold_v <= 0; hold_user <= 0; hold_last <= 0;
+            wr_busy <= 0;
+            o_x0 <= 0; o_x <= 0; o_y <= 0; o_row <= 0;
+            wr_en <= 0; wr_addr <= 0; wr_data <= 0;
+            fin <= 0;
+            done <= 0;
+        end else begin
+            // Pulse done once the final write has landed
+            fin  <= m_valid && wr_busy && o_last;
+            done <= fin;
+
+            if (start && !rd_busy && !wr_busy) begin
+                rd_busy <= 1;
+                wr_busy <= 1;
+                r_x0 <= 0; r_x <= 0; r_y <= 0; r_row <= 0;
+                o_x0 <= 0; o_x <= 0; o_y <= 0; o_row <= 0;
+            end
+
+            // ---------------- Read side ----------------
+            if (take)
+                hold_v <= 0;
+            if (issue) begin
+                hold_v    <= 1;
+                hold_user <= (r_x == 0) && (r_y == 0);
+                hold_last <= (r_x == STRIP-1);
+
+                if (r_x != STRIP-1) begin
+                    r_x <= r_x + 1;
+                end else begin
+                    r_x <= 0;
+                    if (r_y != H-1) begin
+                        r_y   <= r_y + 1;
+                        r_row <= r_row + W;
+                    end else if (r_x0 == LAST) begin
+                        rd_busy <= 0;   // last word of the last strip
+                    end else begin
+                        r_y   <= 0;
+                        r_x0  <= next_x0(r_x0);
+                        r_row <= next_x0(r_x0);
+                    end
+                end
+            end
+
+            // ---------------- Write side ----------------
+            wr_en <= m_valid && wr_busy && o_keep;
+            if (m_valid && wr_busy) begin
+                wr_addr <= o_row + o_x;
+                wr_data <= m_data;
+
+                if (o_last)
+                    wr_busy <= 0;
+
+                if (o_x != STRIP-1) begin
+                    o_x <= o_x + 1;
+                end else begin
+                    o_x <= 0;
+                    if (o_y != H-1) begin
+                        o_y   <= o_y + 1;
+                        o_row <= o_row + W;
+                    end else begin
+                        o_y   <= 0;
+                        o_x0  <= next_x0(o_x0);
+                        o_row <= next_x0(o_x0);
+                    end
+                end
+            end
+        end
+    end
+
+endmodule
+
+
+// ------------------------------------------------------------
+// Testbench: frame memories stand in for external RAM; runs the
+// tiled blur once and writes blurred.hex
+// ------------------------------------------------------------
+module tb_gaussian_blur_tiled;
+
+    reg clk = 0;
+    reg rst = 1;
+    reg start = 0;
+    wire done;
+
+    // ModelSim-friendly: avoid "localparam string"
+    localparam INFILE  = "output.hex";
+    localparam OUTFILE = "blurred.hex";
+
+    parameter integer W = 320;
+    parameter integer H = 240;
+    parameter integer STRIP = 64;
+    localparam integer N  = W*H;
+    localparam integer AW = (N > 1) ? $clog2(N) : 1;
+
+    reg [15:0] frame_buffer [0:N-1];
+    reg [15:0] blur_buffer  [0:N-1];
+    initial begin
+        $readmemh(INFILE, frame_buffer);
+    end
+
+    wire [AW-1:0] rd_addr, wr_addr;
+    wire          rd_en, wr_en;
+    wire [15:0]   wr_data;
+    reg  [15:0]   rd_data = 0;
+
+    // Registered read port that holds its output while idle
+    always @(posedge clk) begin
+        if (rd_en) rd_data <= frame_buffer[rd_addr];
+        if (wr_en) blur_buffer[wr_addr] <= wr_data;
+    end
+
+    gaussian_blur_rgb565_tiled #(
+        .W(W),
+        .H(H),
+        .STRIP(STRIP)
+    ) dut (
+        .clk(clk),
+        .rst(rst),
+        .start(start),
+        .done(done),
+        .rd_addr(rd_addr),
+        .rd_en(rd_en),
+        .rd_data(rd_data),
+        .wr_addr(wr_addr),
+        .wr_en(wr_en),
+        .wr_data(wr_data)
+    );
+
+    always #5 clk = ~clk; // 100 MHz
+
+    integer cycles = 0;
+    always @(posedge clk) if (!rst) cycles <= cycles + 1;
+
+    initial begin
+        #30 rst = 0;
+
+        #20 start = 1;
+        #10 start = 0;
+
+        wait(done);
+
+        $writememh(OUTFILE, blur_buffer);
+
+        $display("Blur complete! Wrote %s (%0d-pixel strips, %0d cycles)",
+                 OUTFILE, STRIP, cycles);
+        #20 $finish;
+    end
+
+endmodule
@@ -0,0 +1,30 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// -------------------------------------------------------
+// RGB pixel struct
+// -------------------------------------------------------
+typedef struct {
+  uint8_t r, g, b;
+} Pixel;
+
+// -------------------------------------------------------
+// Read-only view of packed BGR888 rows, as stored in a BMP.
+// row0 points at the top image row; stride is the byte
+// distance from one row to the next below it (negative for
+// bottom-up BMPs, so rows are walked in place).
+// -------------------------------------------------------
+typedef struct {
+  const uint8_t *row0;
+  ptrdiff_t stride;
+  int w, h;
+} BgrView;
+
+static inline const uint8_t *bgr_row(const BgrView *v, int y) {
+  return v->row0 + (ptrdiff_t)y * v->stride;
+}
+
+#endif  // IMAGE_H
@@ -0,0 +1,267 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_pool.h"
+#include "gauss_blur.h"
+#include "gauss_kernel.h"
+#include "resize.h"
+#include "thread_pool.h"
+
+// -------------------------------------------------------
+// Row-band parallel drivers for the resize and blur
+// kernels. Each band runs the same single-threaded row
+// function, with per-worker scratch, so results are
+// identical for any thread count. Scratch and input copies
+// come from bufs (frame_pool.h; NULL = malloc).
+// -------------------------------------------------------
+
+// Smallest band worth scheduling; keeps the fixed resize's
+// row cache and the blur's 1-row halo overhead small.
+#define PARALLEL_MIN_BAND_ROWS 8
+
+// ---- Fixed-point resize ----
+typedef struct {
+  const ResizeTables *t;
+  const BgrView *src;
+  Pixel *dst;
+  uint16_t *scratch;  // resize_rows_words() per worker
+} ResizeBandCtx;
+
+static inline void resize_band(void *c, int y0, int y1, int worker) {
+  ResizeBandCtx *x = (ResizeBandCtx *)c;
+  resize_bilinear_fixed_rows(x->t, x->src, x->dst, y0, y1,
+                             x->scratch + resize_rows_words(x->t) * worker);
+}
+
+// Returns 0, or -1 on allocation failure or geometry mismatch.
+static inline int resize_bilinear_fixed_mt(ThreadPool *pool, FramePool *bufs,
+                                           const ResizeTables *t,
+                                           const BgrView *src, Pixel *dst) {
+  if (src->w != t->src_w || src->h != t->src_h) return -1;
+  int n = thread_pool_size(pool);
+  uint16_t *scratch = (uint16_t *)frame_pool_get(
+      bufs, resize_rows_words(t) * n * sizeof(uint16_t));
+  if (!scratch) return -1;
+  ResizeBandCtx c = {t, src, dst, scratch};
+  thread_pool_run_bands(pool, t->dst_h, PARALLEL_MIN_BAND_ROWS, resize_band,
+                        &c);
+  frame_pool_put(bufs, scratch);
+  return 0;
+}
+
+// ---- Float reference resize ----
+typedef struct {
+  const BgrView *src;
+  Pixel *dst;
+  int dst_w, dst_h;
+} FloatResizeBandCtx;
+
+static inline void float_resize_band(void *c, int y0, int y1, int worker) {
+  FloatResizeBandCtx *x = (FloatResizeBandCtx *)c;
+  (void)worker;
+  resize_bilinear_rows(x->src, x->dst, x->dst_w, x->dst_h, y0, y1);
+}
+
+static inline void resize_bilinear_mt(ThreadPool *pool, const BgrView *src,
+                                      Pixel *dst, int dst_w, int dst_h) {
+  FloatResizeBandCtx c = {src, dst, dst_w, dst_h};
+  thread_pool_run_bands(pool, dst_h, PARALLEL_MIN_BAND_ROWS,
+                        float_resize_band, &c);
+}
+
+// ---- Area downscale ----
+typedef struct {
+  const AreaTables *t;
+  const BgrView *src;
+  Pixel *dst;
+  uint32_t *acc;  // resize_area_words() per worker
+} AreaBandCtx;
+
+static inline void area_band(void *c, int y0, int y1, int worker) {
+  AreaBandCtx *x = (AreaBandCtx *)c;
+  resize_area_rows(x->t, x->src, x->dst, y0, y1,
+                   x->acc + resize_area_words(x->t) * worker);
+}
+
+// Returns 0, or -1 on allocation failure or geometry mismatch.
+static inline int resize_area_mt(ThreadPool *pool, FramePool *bufs,
+                                 const AreaTables *t, const BgrView *src,
+                                 Pixel *dst) {
+  if (src->w != t->src_w || src->h != t->src_h) return -1;
+  int n = thread_pool_size(pool);
+  uint32_t *acc = (uint32_t *)frame_pool_get(
+      bufs, resize_area_words(t) * n * sizeof(uint32_t));
+  if (!acc) return -1;
+  AreaBandCtx c = {t, src, dst, acc};
+  thread_pool_run_bands(pool, t->dst_h, PARALLEL_MIN_BAND_ROWS, area_band,
+                        &c);
+  frame_pool_put(bufs, acc);
+  return 0;
+}
+
+// ---- 3x3 blur (1-row halo per band) ----
+typedef struct {
+  const uint16_t *in;
+  uint16_t *out;
+  int w, h;
+  uint16_t *rings;  // gauss_ring_words() per worker
+} GaussBandCtx;
+
+static inline void gauss_band(void *c, int y0, int y1, int worker) {
+  GaussBandCtx *x = (GaussBandCtx *)c;
+  gauss_blur_rgb565_rows(x->in, x->out, x->w, x->h, y0, y1,
+                         x->rings + gauss_ring_words(x->w) * worker);
+}
+
+// out may alias in (with more than one thread the input is
+// then copied first, since bands read their neighbours'
+// rows). Returns 0 or -1.
+static inline int gauss_blur_rgb565_mt(ThreadPool *pool, FramePool *bufs,
+                                       const uint16_t *in, uint16_t *out,
+                                       int w, int h) {
+  int n = thread_pool_size(pool);
+  const uint16_t *src = in;
+  uint16_t *copy = NULL;
+  if (out == in && n > 1) {
+    copy = (uint16_t *)frame_pool_get(bufs, (size_t)w * h * sizeof(uint16_t));
+    if (!copy) return -1;
+    memcpy(copy, in, (size_t)w * h * sizeof(uint16_t));
+    src = copy;
+  }
+  uint16_t *rings = (uint16_t *)frame_pool_get(
+      bufs, gauss_ring_words(w) * n * sizeof(uint16_t));
+  if (!rings) {
+    frame_pool_put(bufs, copy);
+    return -1;
+  }
+  GaussBandCtx c = {src, out, w, h, rings};
+  thread_pool_run_bands(pool, h, PARALLEL_MIN_BAND_ROWS, gauss_band, &c);
+  frame_pool_put(bufs, rings);
+  frame_pool_put(bufs, copy);
+  return 0;
+}
+
+// ---- Configurable kernel blur (R-row halo per band) ----
+typedef struct {
+  const GaussKernel *k;
+  const uint16_t *in;
+  uint16_t *out;
+  int w, h;
+  uint32_t *rings;  // gauss_kernel_ring_words() per worker
+} GaussKernelBandCtx;
+
+static inline void gauss_kernel_band(void *c, int y0, int y1, int worker) {
+  GaussKernelBandCtx *x = (GaussKernelBandCtx *)c;
+  gauss_blur_rgb565_kernel_rows(
+      x->k, x->in, x->out, x->w, x->h, y0, y1,
+      x->rings + gauss_kernel_ring_words(x->k, x->w) * worker);
+}
+
+// As gauss_blur_rgb565_mt(), for any GaussKernel; in place,
+// a single thread copies only where gauss_blur_rgb565_kernel()
+// does. Returns 0 or -1.
+static inline int gauss_blur_rgb565_kernel_mt(ThreadPool *pool,
+                                              FramePool *bufs,
+                                              const GaussKernel *k,
+                                              const uint16_t *in,
+                                              uint16_t *out, int w, int h) {
+  if (gauss_kernel_is_default(k))
+    return gauss_blur_rgb565_mt(pool, bufs, in, out, w, h);
+  int n = thread_pool_size(pool);
+  const uint16_t *src = in;
+  uint16_t *copy = NULL;
+  if (out == in && (n > 1 || k->border != GAUSS_BORDER_PASS)) {
+    copy = (uint16_t *)frame_pool_get(bufs, (size_t)w * h * sizeof(uint16_t));
+    if (!copy) return -1;
+    memcpy(copy, in, (size_t)w * h * sizeof(uint16_t));
+    src = copy;
+  }
+  uint32_t *rings = (uint32_t *)frame_pool_get(
+      bufs, gauss_kernel_ring_words(k, w) * n * sizeof(uint32_t));
+  if (!rings) {
+    frame_pool_put(bufs, copy);
+    return -1;
+  }
+  GaussKernelBandCtx c = {k, src, out, w, h, rings};
+  thread_pool_run_bands(pool, h, PARALLEL_MIN_BAND_ROWS, gauss_kernel_band,
+                        &c);
+  frame_pool_put(bufs, rings);
+  frame_pool_put(bufs, copy);
+  return 0;
+}
+
+// ---- Strip-tiled blur (R-column halo per strip) ----
+
+// Origin of the strip after the one at x0 (see below)
+static inline int gauss_strip_next(int x0, int strip, int radius, int w) {
+  int last = w - strip;
+  int next = x0 + strip - 2 * radius;
+  return next > last ? last : next;
+}
+
+// -------------------------------------------------------
+// Golden model of gaussian_blur_rgb565_tiled (src/gs_tiled.v):
+// the frame is blurred as vertical strips of strip columns,
+// each one a strip x h frame of its own, origins
+// x0 = min(k * (strip - 2R), w - strip). Neighbouring strips
+// overlap by the R-column halo on each side; a strip's
+// first/last R columns are only kept where they are the
+// frame's edge, so every mode and kernel gives exactly
+// gauss_blur_rgb565_kernel_mt()'s result. Needs
+// strip > 2R; strip >= w runs untiled. out may alias in
+// (the input is then copied first). Returns 0 or -1.
+// -------------------------------------------------------
+static inline int gauss_blur_rgb565_strips_mt(ThreadPool *pool,
+                                              FramePool *bufs,
+                                              const GaussKernel *k,
+                                              const uint16_t *in,
+                                              uint16_t *out, int w, int h,
+                                              int strip) {
+  int r = k->radius;
+  if (strip >= w)
+    return gauss_blur_rgb565_kernel_mt(pool, bufs, k, in, out, w, h);
+  if (strip <= 2 * r) return -1;
+
+  const uint16_t *src = in;
+  uint16_t *copy = NULL;
+  if (out == in) {
+    copy = (uint16_t *)frame_pool_get(bufs, (size_t)w * h * sizeof(uint16_t));
+    if (!copy) return -1;
+    memcpy(copy, in, (size_t)w * h * sizeof(uint16_t));
+    src = copy;
+  }
+  // One strip in and out: the only per-frame working set
+  uint16_t *sbuf = (uint16_t *)frame_pool_get(
+      bufs, (size_t)strip * h * 2 * sizeof(uint16_t));
+  if (!sbuf) {
+    frame_pool_put(bufs, copy);
+    return -1;
+  }
+  uint16_t *sin = sbuf, *sout = sbuf + (size_t)strip * h;
+
+  int err = 0;
+  for (int x0 = 0;; x0 = gauss_strip_next(x0, strip, r, w)) {
+    for (int y = 0; y < h; y++)
+      memcpy(sin + (size_t)y * strip, src + (size_t)y * w + x0,
+             (size_t)strip * sizeof(uint16_t));
+    if (gauss_blur_rgb565_kernel_mt(pool, bufs, k, sin, sout, strip, h) != 0) {
+      err = -1;
+      break;
+    }
+    int lo = x0 == 0 ? 0 : r;
+    int hi = x0 == w - strip ? strip : strip - r;
+    for (int y = 0; y < h; y++)
+      memcpy(out + (size_t)y * w + x0 + lo, sout + (size_t)y * strip + lo,
+             (size_t)(hi - lo) * sizeof(uint16_t));
+    if (x0 == w - strip) break;
+  }
+  frame_pool_put(bufs, sbuf);
+  frame_pool_put(bufs, copy);
+  return err;
+}
+
+#endif  // PARALLEL_H
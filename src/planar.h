@@ -0,0 +1,479 @@
+#ifndef PLANAR_H
+#define PLANAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_pool.h"
+#include "gauss_blur.h"
+#include "image.h"
+#include "resize.h"
+#include "rgb565.h"
+
+// -------------------------------------------------------
+// Planar (structure-of-arrays) RGB images
+//
+// Three separate 8-bit planes instead of 3-byte Pixels, so
+// row kernels load 16 same-channel samples with one aligned
+// load and need no shuffles. Every plane row starts on a
+// PLANAR_ALIGN boundary (stride is w rounded up); the three
+// planes share one allocation. Kernels here are bit-exact
+// with their interleaved counterparts:
+//
+//  - planar_from_bgr()          : BMP rows → R, G, B planes
+//  - planar_pack_rgb565()       : planes → RGB565 words
+//  - resize_bilinear_fixed_planar(): resize_bilinear_fixed()
+//  - gauss_blur_rgb565_planar() : gauss_blur_rgb565(), run
+//                                 on 5/6/5-bit channel planes
+// -------------------------------------------------------
+#define PLANAR_ALIGN 64
+
+typedef struct {
+  uint8_t *data;      // one block holding the three planes
+  uint8_t *plane[3];  // R, G, B
+  size_t stride;      // bytes per plane row, multiple of PLANAR_ALIGN
+  int w, h;
+} PlanarImage;
+
+static inline void planar_free(PlanarImage *p) {
+  free(p->data);
+  memset(p, 0, sizeof(*p));
+}
+
+// Allocates a w x h image (padding zeroed). Returns 0, or -1
+// on allocation failure.
+static inline int planar_init(PlanarImage *p, int w, int h) {
+  memset(p, 0, sizeof(*p));
+  size_t stride = ((size_t)w + PLANAR_ALIGN - 1) & ~(size_t)(PLANAR_ALIGN - 1);
+  size_t plane = stride * (size_t)h;
+  p->data = (uint8_t *)aligned_alloc(PLANAR_ALIGN, 3 * plane);
+  if (!p->data) return -1;
+  memset(p->data, 0, 3 * plane);
+  for (int c = 0; c < 3; c++) p->plane[c] = p->data + (size_t)c * plane;
+  p->stride = stride;
+  p->w = w;
+  p->h = h;
+  return 0;
+}
+
+// Keeps p if it already has the geometry, else reallocates
+static inline int planar_reshape(PlanarImage *p, int w, int h) {
+  if (p->data && p->w == w && p->h == h) return 0;
+  planar_free(p);
+  return planar_init(p, w, h);
+}
+
+static inline uint8_t *planar_row(const PlanarImage *p, int c, int y) {
+  return p->plane[c] + (size_t)y * p->stride;
+}
+
+// -------------------------------------------------------
+// BGR888 rows → planes (at BMP load time)
+// -------------------------------------------------------
+static inline void planar_from_bgr_scalar(const uint8_t *src, uint8_t *r,
+                                          uint8_t *g, uint8_t *b, int x0,
+                                          int n) {
+  for (int x = x0; x < n; x++) {
+    b[x] = src[x * 3 + 0];
+    g[x] = src[x * 3 + 1];
+    r[x] = src[x * 3 + 2];
+  }
+}
+
+#if RGB565_X86
+// 16 pixels per iteration: PSHUFB deinterleave, then one
+// aligned store per plane
+__attribute__((target("sse4.1"))) static inline int planar_from_bgr_sse41(
+    const uint8_t *src, uint8_t *r, uint8_t *g, uint8_t *b, int n) {
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    __m128i c0, c1, c2;
+    rgb565_deinterleave_x86(src + x * 3, &c0, &c1, &c2);
+    _mm_store_si128((__m128i *)(b + x), c0);
+    _mm_store_si128((__m128i *)(g + x), c1);
+    _mm_store_si128((__m128i *)(r + x), c2);
+  }
+  return x;
+}
+#endif
+
+static inline void planar_from_bgr(const BgrView *src, PlanarImage *dst) {
+#if RGB565_X86
+  int simd = rgb565_kernels()->level >= RGB565_SSE41;
+#endif
+  for (int y = 0; y < src->h; y++) {
+    const uint8_t *row = bgr_row(src, y);
+    uint8_t *r = planar_row(dst, 0, y);
+    uint8_t *g = planar_row(dst, 1, y);
+    uint8_t *b = planar_row(dst, 2, y);
+    int x = 0;
+#if RGB565_X86
+    if (simd) x = planar_from_bgr_sse41(row, r, g, b, src->w);
+#endif
+    planar_from_bgr_scalar(row, r, g, b, x, src->w);
+  }
+}
+
+// -------------------------------------------------------
+// Planes → RGB565 (to_rgb565() per pixel)
+// -------------------------------------------------------
+#if RGB565_X86
+// ---- SSE2: 16 pixels per iteration ----
+static inline int planar_pack_row_sse2(const uint8_t *r, const uint8_t *g,
+                                       const uint8_t *b, uint16_t *out,
+                                       int n) {
+  const __m128i z = _mm_setzero_si128();
+  const __m128i mr = _mm_set1_epi16((short)0xF800);
+  const __m128i mg = _mm_set1_epi16(0x07E0);
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    __m128i vr = _mm_load_si128((const __m128i *)(r + x));
+    __m128i vg = _mm_load_si128((const __m128i *)(g + x));
+    __m128i vb = _mm_load_si128((const __m128i *)(b + x));
+    for (int h = 0; h < 2; h++) {
+      __m128i r16 = h ? _mm_unpackhi_epi8(vr, z) : _mm_unpacklo_epi8(vr, z);
+      __m128i g16 = h ? _mm_unpackhi_epi8(vg, z) : _mm_unpacklo_epi8(vg, z);
+      __m128i b16 = h ? _mm_unpackhi_epi8(vb, z) : _mm_unpacklo_epi8(vb, z);
+      __m128i px = _mm_or_si128(
+          _mm_or_si128(_mm_and_si128(_mm_slli_epi16(r16, 8), mr),
+                       _mm_and_si128(_mm_slli_epi16(g16, 3), mg)),
+          _mm_srli_epi16(b16, 3));
+      _mm_storeu_si128((__m128i *)(out + x + h * 8), px);
+    }
+  }
+  return x;
+}
+#endif
+
+static inline void planar_pack_rgb565(const PlanarImage *src, uint16_t *out) {
+  int w = src->w;
+  for (int y = 0; y < src->h; y++) {
+    const uint8_t *r = planar_row(src, 0, y);
+    const uint8_t *g = planar_row(src, 1, y);
+    const uint8_t *b = planar_row(src, 2, y);
+    uint16_t *o = out + (size_t)y * w;
+    int x = 0;
+#if RGB565_X86
+    x = planar_pack_row_sse2(r, g, b, o, w);
+#endif
+    for (; x < w; x++) o[x] = to_rgb565(r[x], g[x], b[x]);
+  }
+}
+
+// -------------------------------------------------------
+// Fixed-point bilinear resize on planes, with the tables
+// of resize_bilinear_fixed(): the same Q8 horizontal and
+// vertical passes, one plane at a time. The horizontal
+// pass is still a gather (taps follow the scale), but the
+// vertical pass, where the multiplies are, runs on
+// contiguous uint16 rows. Returns 0, or -1 on allocation
+// failure or geometry that does not match t.
+// -------------------------------------------------------
+static inline void resize_planar_hpass(const int32_t *xi0, const int32_t *xi1,
+                                       const uint16_t *xw, const uint8_t *row,
+                                       uint16_t *out, int n) {
+  for (int x = 0; x < n; x++) {
+    unsigned w1 = xw[x];
+    out[x] = (uint16_t)(row[xi0[x]] * (RESIZE_ONE - w1) + row[xi1[x]] * w1);
+  }
+}
+
+#if RGB565_X86
+// (top * w0 + bot * w1) >> 16 for 16 lanes; the products need
+// 32 bits, so each is built from its low and high halves
+static inline int resize_planar_vpass_sse2(const uint16_t *top,
+                                           const uint16_t *bot, unsigned w1,
+                                           uint8_t *out, int n) {
+  const __m128i v0 = _mm_set1_epi16((short)(RESIZE_ONE - w1));
+  const __m128i v1 = _mm_set1_epi16((short)w1);
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    __m128i res[2];
+    for (int h = 0; h < 2; h++) {
+      __m128i t = _mm_loadu_si128((const __m128i *)(top + x + h * 8));
+      __m128i b = _mm_loadu_si128((const __m128i *)(bot + x + h * 8));
+      __m128i tl = _mm_mullo_epi16(t, v0), th = _mm_mulhi_epu16(t, v0);
+      __m128i bl = _mm_mullo_epi16(b, v1), bh = _mm_mulhi_epu16(b, v1);
+      __m128i lo = _mm_add_epi32(_mm_unpacklo_epi16(tl, th),
+                                 _mm_unpacklo_epi16(bl, bh));
+      __m128i hi = _mm_add_epi32(_mm_unpackhi_epi16(tl, th),
+                                 _mm_unpackhi_epi16(bl, bh));
+      res[h] = _mm_packs_epi32(_mm_srli_epi32(lo, 2 * RESIZE_FRAC_BITS),
+                               _mm_srli_epi32(hi, 2 * RESIZE_FRAC_BITS));
+    }
+    _mm_store_si128((__m128i *)(out + x), _mm_packus_epi16(res[0], res[1]));
+  }
+  return x;
+}
+#endif
+
+static inline void resize_planar_vpass(const uint16_t *top,
+                                       const uint16_t *bot, unsigned w1,
+                                       uint8_t *out, int n) {
+  unsigned w0 = RESIZE_ONE - w1;
+  int x = 0;
+#if RGB565_X86
+  x = resize_planar_vpass_sse2(top, bot, w1, out, n);
+#endif
+  for (; x < n; x++)
+    out[x] = (uint8_t)((top[x] * w0 + bot[x] * w1) >> (2 * RESIZE_FRAC_BITS));
+}
+
+static inline int resize_bilinear_fixed_planar(FramePool *bufs,
+                                               const ResizeTables *t,
+                                               const PlanarImage *src,
+                                               PlanarImage *dst) {
+  if (src->w != t->src_w || src->h != t->src_h || dst->w != t->dst_w ||
+      dst->h != t->dst_h)
+    return -1;
+  int n = t->dst_w;
+  // Plane column indices (the tables hold BGR byte offsets) and
+  // two cached horizontal rows per plane
+  int32_t *xi =
+      (int32_t *)frame_pool_get(bufs, 2 * (size_t)n * sizeof(int32_t));
+  uint16_t *rows =
+      (uint16_t *)frame_pool_get(bufs, 6 * (size_t)n * sizeof(uint16_t));
+  if (!xi || !rows) {
+    frame_pool_put(bufs, xi);
+    frame_pool_put(bufs, rows);
+    return -1;
+  }
+  for (int x = 0; x < n; x++) {
+    xi[x] = t->x0[x] / 3;
+    xi[n + x] = t->x1[x] / 3;
+  }
+
+  for (int c = 0; c < 3; c++) {
+    uint16_t *h[2] = {rows + (size_t)c * 2 * n, rows + ((size_t)c * 2 + 1) * n};
+    int h_row[2] = {-1, -1};
+    for (int dst_y = 0; dst_y < t->dst_h; dst_y++) {
+      int need0 = t->y0[dst_y], need1 = t->y1[dst_y];
+      const uint8_t *p0 = planar_row(src, c, need0);
+      const uint8_t *p1 = planar_row(src, c, need1);
+      // Same row cache as resize_bilinear_fixed_row()
+      int s0 = h_row[0] == need0 ? 0 : h_row[1] == need0 ? 1 : -1;
+      if (s0 < 0) {
+        s0 = h_row[0] == need1 ? 1 : 0;
+        resize_planar_hpass(xi, xi + n, t->xw, p0, h[s0], n);
+        h_row[s0] = need0;
+      }
+      int s1 = s0;
+      if (need1 != need0) {
+        s1 = s0 ^ 1;
+        if (h_row[s1] != need1) {
+          resize_planar_hpass(xi, xi + n, t->xw, p1, h[s1], n);
+          h_row[s1] = need1;
+        }
+      }
+      resize_planar_vpass(h[s0], h[s1], t->yw[dst_y],
+                          planar_row(dst, c, dst_y), n);
+    }
+  }
+  frame_pool_put(bufs, xi);
+  frame_pool_put(bufs, rows);
+  return 0;
+}
+
+// -------------------------------------------------------
+// 3x3 blur on 5/6/5-bit channel planes
+//
+// gauss_blur_rgb565_planar() splits an RGB565 frame into
+// R5, G6 and B5 planes, blurs each with the 1-2-1 kernel
+// (>> 4, border pixels pass through) and packs the result:
+// the same integers as gauss_blur_rgb565(), but every row
+// kernel is one channel wide with no field extraction.
+// -------------------------------------------------------
+static inline void planar_split_rgb565(const uint16_t *in, PlanarImage *p) {
+  for (int y = 0; y < p->h; y++) {
+    const uint16_t *s = in + (size_t)y * p->w;
+    uint8_t *r = planar_row(p, 0, y);
+    uint8_t *g = planar_row(p, 1, y);
+    uint8_t *b = planar_row(p, 2, y);
+    int x = 0;
+#if RGB565_X86
+    const __m128i k3f = _mm_set1_epi16(0x3F);
+    const __m128i k1f = _mm_set1_epi16(0x1F);
+    for (; x + 16 <= p->w; x += 16) {
+      __m128i a = _mm_loadu_si128((const __m128i *)(s + x));
+      __m128i c = _mm_loadu_si128((const __m128i *)(s + x + 8));
+      _mm_store_si128((__m128i *)(r + x),
+                      _mm_packus_epi16(_mm_srli_epi16(a, 11),
+                                       _mm_srli_epi16(c, 11)));
+      _mm_store_si128(
+          (__m128i *)(g + x),
+          _mm_packus_epi16(_mm_and_si128(_mm_srli_epi16(a, 5), k3f),
+                           _mm_and_si128(_mm_srli_epi16(c, 5), k3f)));
+      _mm_store_si128((__m128i *)(b + x),
+                      _mm_packus_epi16(_mm_and_si128(a, k1f),
+                                       _mm_and_si128(c, k1f)));
+    }
+#endif
+    for (; x < p->w; x++) {
+      r[x] = (uint8_t)(s[x] >> 11);
+      g[x] = (uint8_t)((s[x] >> 5) & 0x3F);
+      b[x] = (uint8_t)(s[x] & 0x1F);
+    }
+  }
+}
+
+static inline void planar_join_rgb565(const PlanarImage *p, uint16_t *out) {
+  for (int y = 0; y < p->h; y++) {
+    const uint8_t *r = planar_row(p, 0, y);
+    const uint8_t *g = planar_row(p, 1, y);
+    const uint8_t *b = planar_row(p, 2, y);
+    uint16_t *o = out + (size_t)y * p->w;
+    int x = 0;
+#if RGB565_X86
+    const __m128i z = _mm_setzero_si128();
+    for (; x + 16 <= p->w; x += 16) {
+      __m128i vr = _mm_load_si128((const __m128i *)(r + x));
+      __m128i vg = _mm_load_si128((const __m128i *)(g + x));
+      __m128i vb = _mm_load_si128((const __m128i *)(b + x));
+      for (int h = 0; h < 2; h++) {
+        __m128i r16 = h ? _mm_unpackhi_epi8(vr, z) : _mm_unpacklo_epi8(vr, z);
+        __m128i g16 = h ? _mm_unpackhi_epi8(vg, z) : _mm_unpacklo_epi8(vg, z);
+        __m128i b16 = h ? _mm_unpackhi_epi8(vb, z) : _mm_unpacklo_epi8(vb, z);
+        _mm_storeu_si128((__m128i *)(o + x + h * 8),
+                         _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r16, 11),
+                                                   _mm_slli_epi16(g16, 5)),
+                                      b16));
+      }
+    }
+#endif
+    for (; x < p->w; x++)
+      o[x] = (uint16_t)((r[x] << 11) | (g[x] << 5) | b[x]);
+  }
+}
+
+// Channels are at most 6 bits, so the vertical 1-2-1 of a
+// column (<= 4 * 63) still fits a byte: each interior row
+// is one byte-wide vertical pass into v, then one 16-bit
+// horizontal pass from v.
+#if RGB565_X86
+__attribute__((target("avx2"))) static inline int gauss_plane_v121_avx2(
+    const uint8_t *t, const uint8_t *m, const uint8_t *b, uint8_t *v, int w) {
+  int x = 0;
+  for (; x + 32 <= w; x += 32) {
+    __m256i vt = _mm256_load_si256((const __m256i *)(t + x));
+    __m256i vm = _mm256_load_si256((const __m256i *)(m + x));
+    __m256i vb = _mm256_load_si256((const __m256i *)(b + x));
+    _mm256_storeu_si256(
+        (__m256i *)(v + x),
+        _mm256_add_epi8(_mm256_add_epi8(vt, vb), _mm256_add_epi8(vm, vm)));
+  }
+  return x;
+}
+
+// 32 outputs per iteration; unpack/pack work per 128-bit lane,
+// so they pair up and the result comes out in order
+__attribute__((target("avx2"))) static inline int gauss_plane_h121_avx2(
+    const uint8_t *v, uint8_t *out, int w) {
+  const __m256i z = _mm256_setzero_si256();
+  int x = 1;
+  for (; x + 32 <= w - 1; x += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(v + x - 1));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(v + x));
+    __m256i c = _mm256_loadu_si256((const __m256i *)(v + x + 1));
+    __m256i lo = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_unpacklo_epi8(a, z),
+                         _mm256_unpacklo_epi8(c, z)),
+        _mm256_slli_epi16(_mm256_unpacklo_epi8(b, z), 1));
+    __m256i hi = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_unpackhi_epi8(a, z),
+                         _mm256_unpackhi_epi8(c, z)),
+        _mm256_slli_epi16(_mm256_unpackhi_epi8(b, z), 1));
+    _mm256_storeu_si256((__m256i *)(out + x),
+                        _mm256_packus_epi16(_mm256_srli_epi16(lo, 4),
+                                            _mm256_srli_epi16(hi, 4)));
+  }
+  return x;
+}
+#endif
+
+static inline void gauss_plane_v121(const uint8_t *t, const uint8_t *m,
+                                    const uint8_t *b, uint8_t *v, int w) {
+  int x = 0;
+#if RGB565_X86
+  if (gauss_have_avx2()) x = gauss_plane_v121_avx2(t, m, b, v, w);
+  for (; x + 16 <= w; x += 16) {
+    __m128i vt = _mm_load_si128((const __m128i *)(t + x));
+    __m128i vm = _mm_load_si128((const __m128i *)(m + x));
+    __m128i vb = _mm_load_si128((const __m128i *)(b + x));
+    _mm_storeu_si128((__m128i *)(v + x),
+                     _mm_add_epi8(_mm_add_epi8(vt, vb), _mm_add_epi8(vm, vm)));
+  }
+#endif
+  for (; x < w; x++) v[x] = (uint8_t)(t[x] + b[x] + 2 * m[x]);
+}
+
+static inline void gauss_plane_h121(const uint8_t *v, uint8_t *out, int w) {
+  int x = 1;
+#if RGB565_X86
+  const __m128i z = _mm_setzero_si128();
+  if (gauss_have_avx2()) x = gauss_plane_h121_avx2(v, out, w);
+  for (; x + 16 <= w - 1; x += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(v + x - 1));
+    __m128i b = _mm_loadu_si128((const __m128i *)(v + x));
+    __m128i c = _mm_loadu_si128((const __m128i *)(v + x + 1));
+    __m128i lo = _mm_add_epi16(
+        _mm_add_epi16(_mm_unpacklo_epi8(a, z), _mm_unpacklo_epi8(c, z)),
+        _mm_slli_epi16(_mm_unpacklo_epi8(b, z), 1));
+    __m128i hi = _mm_add_epi16(
+        _mm_add_epi16(_mm_unpackhi_epi8(a, z), _mm_unpackhi_epi8(c, z)),
+        _mm_slli_epi16(_mm_unpackhi_epi8(b, z), 1));
+    _mm_storeu_si128((__m128i *)(out + x),
+                     _mm_packus_epi16(_mm_srli_epi16(lo, 4),
+                                      _mm_srli_epi16(hi, 4)));
+  }
+#endif
+  for (; x < w - 1; x++)
+    out[x] = (uint8_t)((v[x - 1] + 2u * v[x] + v[x + 1]) >> 4);
+}
+
+// One w x h plane of values <= 63 (stride bytes per row,
+// out != in); v is scratch for one row of w bytes
+static inline void gauss_blur_plane(const uint8_t *in, uint8_t *out, int w,
+                                    int h, size_t stride, uint8_t *v) {
+  for (int y = 0; y < h; y++) {
+    const uint8_t *m = in + (size_t)y * stride;
+    uint8_t *o = out + (size_t)y * stride;
+    if (y == 0 || y == h - 1 || w < 3) {
+      memcpy(o, m, (size_t)w);
+      continue;
+    }
+    gauss_plane_v121(m - stride, m, m + stride, v, w);
+    gauss_plane_h121(v, o, w);
+    // Left/right border columns pass through
+    o[0] = m[0];
+    o[w - 1] = m[w - 1];
+  }
+}
+
+// out may alias in. Returns 0, or -1 on allocation failure.
+static inline int gauss_blur_rgb565_planar(const uint16_t *in, uint16_t *out,
+                                           int w, int h) {
+  PlanarImage a, b;
+  if (planar_init(&a, w, h) != 0) return -1;
+  if (planar_init(&b, w, h) != 0) {
+    planar_free(&a);
+    return -1;
+  }
+  planar_split_rgb565(in, &a);
+  uint8_t *v = (uint8_t *)malloc((size_t)w);
+  if (!v) {
+    planar_free(&a);
+    planar_free(&b);
+    return -1;
+  }
+  for (int c = 0; c < 3; c++)
+    gauss_blur_plane(a.plane[c], b.plane[c], w, h, a.stride, v);
+  free(v);
+  planar_join_rgb565(&b, out);
+  planar_free(&a);
+  planar_free(&b);
+  return 0;
+}
+
+#endif  // PLANAR_H
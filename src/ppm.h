@@ -0,0 +1,60 @@
+#ifndef PPM_H
+#define PPM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_pool.h"
+#include "rgb565.h"
+#include "stage_stats.h"
+
+// -------------------------------------------------------
+// RGB565 frame -> binary PPM (P6, RGB888)
+// The whole file (header + body) is built in one buffer
+// and written with a single fwrite; the unpack is
+// vectorized where the CPU allows. The buffer comes from
+// bufs (NULL = malloc); with stats set, the unpack and the
+// write are timed as the expand and ppm_write stages.
+// Shared by convert and the in-process simulator driver
+// (test/sim_dpi.cpp).
+// Returns 0 on success, -1 after printing an error.
+// -------------------------------------------------------
+static inline int write_ppm_rgb565(FramePool *bufs, Stats *stats,
+                                   const char *path, const uint16_t *pixels,
+                                   int w, int h) {
+  size_t npix = (size_t)w * h;
+  char header[32];
+  int header_len = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", w, h);
+  size_t ppm_len = (size_t)header_len + npix * 3;
+  uint8_t *ppm = (uint8_t *)frame_pool_get(bufs, ppm_len);
+  if (!ppm) {
+    fprintf(stderr, "Memory allocation failed.\n");
+    return -1;
+  }
+  memcpy(ppm, header, (size_t)header_len);
+  double t0 = stats_clock(stats);
+  rgb565_unpack_rgb(pixels, ppm + header_len, npix);
+  stats_add(stats, STAGE_EXPAND, t0, npix, npix * sizeof(uint16_t));
+
+  t0 = stats_clock(stats);
+  FILE *fp = fopen(path, "wb");
+  if (!fp) {
+    perror(path);
+    frame_pool_put(bufs, ppm);
+    return -1;
+  }
+  int write_err = fwrite(ppm, 1, ppm_len, fp) != ppm_len;
+  frame_pool_put(bufs, ppm);
+  if (fclose(fp) != 0) write_err = 1;
+  if (write_err) {
+    fprintf(stderr, "Error: failed writing %s\n", path);
+    return -1;
+  }
+  stats_add(stats, STAGE_PPM_WRITE, t0, npix, ppm_len);
+  return 0;
+}
+
+#endif  // PPM_H
@@ -0,0 +1,352 @@
+#ifndef RESIZE_H
+#define RESIZE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "image.h"
+
+// -------------------------------------------------------
+// Bilinear resize: src (src_w x src_h) → dst (dst_w x dst_h)
+// Samples the BGR rows of src in place (no staging copy).
+// Float reference; see resize_bilinear_fixed() below.
+// resize_bilinear_rows() fills destination rows
+// [y_begin, y_end) of an already allocated dst,
+// resize_bilinear_row() the single row dst_y into out.
+// -------------------------------------------------------
+static inline void resize_bilinear_row(const BgrView *src, Pixel *out,
+                                       int dst_w, int dst_h, int dst_y) {
+  int src_w = src->w;
+  int src_h = src->h;
+
+  float x_scale = (float)src_w / dst_w;
+  float y_scale = (float)src_h / dst_h;
+
+  for (int dst_x = 0; dst_x < dst_w; dst_x++) {
+    float src_xf = dst_x * x_scale;
+    float src_yf = dst_y * y_scale;
+
+    int x0 = (int)src_xf;
+    int y0 = (int)src_yf;
+    int x1 = x0 + 1 < src_w ? x0 + 1 : x0;
+    int y1 = y0 + 1 < src_h ? y0 + 1 : y0;
+
+    float dx = src_xf - x0;
+    float dy = src_yf - y0;
+
+    // BMP channel order is B, G, R
+    const uint8_t *row0 = bgr_row(src, y0);
+    const uint8_t *row1 = bgr_row(src, y1);
+    Pixel p00 = {row0[x0 * 3 + 2], row0[x0 * 3 + 1], row0[x0 * 3 + 0]};
+    Pixel p10 = {row0[x1 * 3 + 2], row0[x1 * 3 + 1], row0[x1 * 3 + 0]};
+    Pixel p01 = {row1[x0 * 3 + 2], row1[x0 * 3 + 1], row1[x0 * 3 + 0]};
+    Pixel p11 = {row1[x1 * 3 + 2], row1[x1 * 3 + 1], row1[x1 * 3 + 0]};
+
+    // Bilinear interpolation for each channel
+    out[dst_x].r =
+        (uint8_t)(p00.r * (1 - dx) * (1 - dy) + p10.r * dx * (1 - dy) +
+                  p01.r * (1 - dx) * dy + p11.r * dx * dy);
+    out[dst_x].g =
+        (uint8_t)(p00.g * (1 - dx) * (1 - dy) + p10.g * dx * (1 - dy) +
+                  p01.g * (1 - dx) * dy + p11.g * dx * dy);
+    out[dst_x].b =
+        (uint8_t)(p00.b * (1 - dx) * (1 - dy) + p10.b * dx * (1 - dy) +
+                  p01.b * (1 - dx) * dy + p11.b * dx * dy);
+  }
+}
+
+static inline void resize_bilinear_rows(const BgrView *src, Pixel *dst,
+                                        int dst_w, int dst_h, int y_begin,
+                                        int y_end) {
+  for (int dst_y = y_begin; dst_y < y_end; dst_y++)
+    resize_bilinear_row(src, dst + (size_t)dst_y * dst_w, dst_w, dst_h, dst_y);
+}
+
+static inline Pixel *resize_bilinear(const BgrView *src, int dst_w,
+                                     int dst_h) {
+  Pixel *dst = (Pixel *)malloc(dst_w * dst_h * sizeof(Pixel));
+  if (!dst) return NULL;
+  resize_bilinear_rows(src, dst, dst_w, dst_h, 0, dst_h);
+  return dst;
+}
+
+// -------------------------------------------------------
+// Fixed-point separable bilinear resize
+//
+// Source positions are computed exactly as in
+// resize_bilinear(), once per (src, dst) geometry, and
+// stored as index/weight tables. Each frame then runs a
+// horizontal pass over the (at most two) source rows a
+// destination row needs, and a vertical pass blending
+// those rows. Weights are Q8, so the horizontal pass fits
+// in uint16 and the vertical pass in uint32. Results stay
+// within 1 LSB of the float reference.
+// -------------------------------------------------------
+#define RESIZE_FRAC_BITS 8
+#define RESIZE_ONE (1 << RESIZE_FRAC_BITS)
+
+typedef struct {
+  int src_w, src_h, dst_w, dst_h;
+  int32_t *x0, *x1;  // byte offsets of the left/right taps in a BGR row
+  uint16_t *xw;      // Q8 weight of the right tap
+  int32_t *y0, *y1;  // top/bottom source rows
+  uint16_t *yw;      // Q8 weight of the bottom row
+} ResizeTables;
+
+static inline void resize_tables_free(ResizeTables *t) {
+  free(t->x0);
+  free(t->y0);
+  memset(t, 0, sizeof(*t));
+}
+
+static inline uint16_t resize_weight(float frac) {
+  int w = (int)(frac * RESIZE_ONE + 0.5f);
+  return (uint16_t)(w > RESIZE_ONE ? RESIZE_ONE : w);
+}
+
+// Returns 0 on success, -1 on allocation failure.
+static inline int resize_tables_init(ResizeTables *t, int src_w, int src_h,
+                                     int dst_w, int dst_h) {
+  memset(t, 0, sizeof(*t));
+  t->src_w = src_w;
+  t->src_h = src_h;
+  t->dst_w = dst_w;
+  t->dst_h = dst_h;
+
+  // One block per axis: x0 | x1 | xw and y0 | y1 | yw
+  size_t xs = (size_t)dst_w * (2 * sizeof(int32_t) + sizeof(uint16_t));
+  size_t ys = (size_t)dst_h * (2 * sizeof(int32_t) + sizeof(uint16_t));
+  t->x0 = (int32_t *)malloc(xs);
+  t->y0 = (int32_t *)malloc(ys);
+  if (!t->x0 || !t->y0) {
+    resize_tables_free(t);
+    return -1;
+  }
+  t->x1 = t->x0 + dst_w;
+  t->xw = (uint16_t *)(t->x1 + dst_w);
+  t->y1 = t->y0 + dst_h;
+  t->yw = (uint16_t *)(t->y1 + dst_h);
+
+  float x_scale = (float)src_w / dst_w;
+  float y_scale = (float)src_h / dst_h;
+
+  for (int dst_x = 0; dst_x < dst_w; dst_x++) {
+    float src_xf = dst_x * x_scale;
+    int x0 = (int)src_xf;
+    int x1 = x0 + 1 < src_w ? x0 + 1 : x0;
+    t->x0[dst_x] = x0 * 3;
+    t->x1[dst_x] = x1 * 3;
+    t->xw[dst_x] = resize_weight(src_xf - x0);
+  }
+  for (int dst_y = 0; dst_y < dst_h; dst_y++) {
+    float src_yf = dst_y * y_scale;
+    int y0 = (int)src_yf;
+    int y1 = y0 + 1 < src_h ? y0 + 1 : y0;
+    t->y0[dst_y] = y0;
+    t->y1[dst_y] = y1;
+    t->yw[dst_y] = resize_weight(src_yf - y0);
+  }
+  return 0;
+}
+
+// Horizontal pass: one BGR source row → dst_w RGB samples in Q8
+static inline void resize_hpass(const ResizeTables *t, const uint8_t *row,
+                                uint16_t *out) {
+  for (int x = 0; x < t->dst_w; x++) {
+    const uint8_t *a = row + t->x0[x];
+    const uint8_t *b = row + t->x1[x];
+    unsigned w1 = t->xw[x];
+    unsigned w0 = RESIZE_ONE - w1;
+    out[x * 3 + 0] = (uint16_t)(a[2] * w0 + b[2] * w1);
+    out[x * 3 + 1] = (uint16_t)(a[1] * w0 + b[1] * w1);
+    out[x * 3 + 2] = (uint16_t)(a[0] * w0 + b[0] * w1);
+  }
+}
+
+// Vertical pass: blend two Q8 rows into one row of pixels
+static inline void resize_vpass(const uint16_t *top, const uint16_t *bot,
+                                unsigned w1, Pixel *out, int n) {
+  unsigned w0 = RESIZE_ONE - w1;
+  uint8_t *o = (uint8_t *)out;
+  for (int i = 0; i < n * 3; i++) {
+    o[i] = (uint8_t)((top[i] * w0 + bot[i] * w1) >> (2 * RESIZE_FRAC_BITS));
+  }
+}
+
+// -------------------------------------------------------
+// Resize destination row dst_y of src into out. rows is
+// scratch for two horizontal-pass rows (6 * dst_w uint16)
+// and h_row the source rows they hold ({-1, -1} before the
+// first call); consecutive destination rows usually share
+// one or both, so a top-to-bottom walk runs each source
+// row's horizontal pass once.
+// -------------------------------------------------------
+static inline void resize_bilinear_fixed_row(const ResizeTables *t,
+                                             const BgrView *src, int dst_y,
+                                             Pixel *out, uint16_t *rows,
+                                             int h_row[2]) {
+  uint16_t *h[2] = {rows, rows + 3 * t->dst_w};
+  int need0 = t->y0[dst_y];
+  int need1 = t->y1[dst_y];
+
+  int s0 = h_row[0] == need0 ? 0 : h_row[1] == need0 ? 1 : -1;
+  if (s0 < 0) {
+    s0 = h_row[0] == need1 ? 1 : 0;
+    resize_hpass(t, bgr_row(src, need0), h[s0]);
+    h_row[s0] = need0;
+  }
+  int s1 = s0;
+  if (need1 != need0) {
+    s1 = s0 ^ 1;
+    if (h_row[s1] != need1) {
+      resize_hpass(t, bgr_row(src, need1), h[s1]);
+      h_row[s1] = need1;
+    }
+  }
+  resize_vpass(h[s0], h[s1], t->yw[dst_y], out, t->dst_w);
+}
+
+// -------------------------------------------------------
+// Resize destination rows [y_begin, y_end) of src into dst
+// (dst points at row 0 of a dst_w x dst_h image). rows is
+// scratch for two horizontal-pass rows: 6 * dst_w uint16.
+// -------------------------------------------------------
+static inline void resize_bilinear_fixed_rows(const ResizeTables *t,
+                                              const BgrView *src, Pixel *dst,
+                                              int y_begin, int y_end,
+                                              uint16_t *rows) {
+  int h_row[2] = {-1, -1};
+  for (int dst_y = y_begin; dst_y < y_end; dst_y++)
+    resize_bilinear_fixed_row(t, src, dst_y, dst + (size_t)dst_y * t->dst_w,
+                              rows, h_row);
+}
+
+// Horizontal-pass scratch for resize_bilinear_fixed_rows(), in uint16
+static inline size_t resize_rows_words(const ResizeTables *t) {
+  return 6 * (size_t)t->dst_w;
+}
+
+// Whole-frame convenience wrapper. Returns 0, or -1 on
+// allocation failure or a src that does not match t.
+static inline int resize_bilinear_fixed(const ResizeTables *t,
+                                        const BgrView *src, Pixel *dst) {
+  if (src->w != t->src_w || src->h != t->src_h) return -1;
+  uint16_t *rows = (uint16_t *)malloc(resize_rows_words(t) * sizeof(uint16_t));
+  if (!rows) return -1;
+  resize_bilinear_fixed_rows(t, src, dst, 0, t->dst_h, rows);
+  free(rows);
+  return 0;
+}
+
+// -------------------------------------------------------
+// Area (box) downscale, for reductions beyond 2x where
+// bilinear's 4 taps skip most of the source and alias.
+//
+// Output pixel (x, y) is the rounded mean of the source
+// block [xb[x], xb[x+1]) x [yb[y], yb[y+1]), with
+// xb[x] = x * src_w / dst_w. The blocks tile the source,
+// so every source pixel is read exactly once: each row is
+// walked left to right and added into a dst_w-wide row of
+// per-channel sums, which is divided out once the block
+// row is complete. Needs src_w >= dst_w and src_h >= dst_h.
+// -------------------------------------------------------
+typedef struct {
+  int src_w, src_h, dst_w, dst_h;
+  int32_t *xb;  // dst_w + 1 column boundaries
+  int32_t *yb;  // dst_h + 1 row boundaries
+} AreaTables;
+
+// Largest block the uint32 sums can hold (255 * n < 2^32)
+#define RESIZE_AREA_MAX_BLOCK (UINT32_MAX / 255u)
+
+static inline void area_tables_free(AreaTables *t) {
+  free(t->xb);
+  memset(t, 0, sizeof(*t));
+}
+
+// Returns 0 on success, -1 on allocation failure or a
+// geometry the area filter cannot take (upscaling an axis,
+// or blocks too large for the sums).
+static inline int area_tables_init(AreaTables *t, int src_w, int src_h,
+                                   int dst_w, int dst_h) {
+  memset(t, 0, sizeof(*t));
+  if (dst_w <= 0 || dst_h <= 0 || src_w < dst_w || src_h < dst_h) return -1;
+  uint64_t bw = ((uint64_t)src_w + dst_w - 1) / dst_w;
+  uint64_t bh = ((uint64_t)src_h + dst_h - 1) / dst_h;
+  if (bw * bh > RESIZE_AREA_MAX_BLOCK) return -1;
+
+  t->xb = (int32_t *)malloc(((size_t)dst_w + dst_h + 2) * sizeof(int32_t));
+  if (!t->xb) return -1;
+  t->yb = t->xb + dst_w + 1;
+  t->src_w = src_w;
+  t->src_h = src_h;
+  t->dst_w = dst_w;
+  t->dst_h = dst_h;
+  for (int x = 0; x <= dst_w; x++)
+    t->xb[x] = (int32_t)((int64_t)x * src_w / dst_w);
+  for (int y = 0; y <= dst_h; y++)
+    t->yb[y] = (int32_t)((int64_t)y * src_h / dst_h);
+  return 0;
+}
+
+// Add one BGR source row into the RGB block sums
+static inline void resize_area_hpass(const AreaTables *t, const uint8_t *row,
+                                     uint32_t *acc) {
+  const uint8_t *p = row;
+  for (int x = 0; x < t->dst_w; x++) {
+    uint32_t r = 0, g = 0, b = 0;
+    for (int sx = t->xb[x]; sx < t->xb[x + 1]; sx++, p += 3) {
+      b += p[0];
+      g += p[1];
+      r += p[2];
+    }
+    acc[x * 3 + 0] += r;
+    acc[x * 3 + 1] += g;
+    acc[x * 3 + 2] += b;
+  }
+}
+
+// Downscale destination row dst_y of src into out; acc is
+// scratch for one row of sums (resize_area_words() uint32)
+static inline void resize_area_row(const AreaTables *t, const BgrView *src,
+                                   int dst_y, Pixel *out, uint32_t *acc) {
+  memset(acc, 0, 3 * (size_t)t->dst_w * sizeof(uint32_t));
+  for (int sy = t->yb[dst_y]; sy < t->yb[dst_y + 1]; sy++)
+    resize_area_hpass(t, bgr_row(src, sy), acc);
+
+  uint32_t bh = (uint32_t)(t->yb[dst_y + 1] - t->yb[dst_y]);
+  uint8_t *o = (uint8_t *)out;
+  for (int x = 0; x < t->dst_w; x++) {
+    uint32_t n = bh * (uint32_t)(t->xb[x + 1] - t->xb[x]);
+    for (int c = 0; c < 3; c++)
+      o[x * 3 + c] = (uint8_t)((acc[x * 3 + c] + n / 2) / n);
+  }
+}
+
+// -------------------------------------------------------
+// Downscale destination rows [y_begin, y_end) of src into
+// dst (row 0 of a dst_w x dst_h image). acc is scratch for
+// one row of sums: resize_area_words() uint32.
+// -------------------------------------------------------
+static inline void resize_area_rows(const AreaTables *t, const BgrView *src,
+                                    Pixel *dst, int y_begin, int y_end,
+                                    uint32_t *acc) {
+  for (int dst_y = y_begin; dst_y < y_end; dst_y++)
+    resize_area_row(t, src, dst_y, dst + (size_t)dst_y * t->dst_w, acc);
+}
+
+// Row-sum scratch for resize_area_rows(), in uint32
+static inline size_t resize_area_words(const AreaTables *t) {
+  return 3 * (size_t)t->dst_w;
+}
+
+// Whether the area filter should replace bilinear: some
+// axis shrinks by more than 2x and neither axis grows
+static inline int resize_wants_area(int src_w, int src_h, int dst_w,
+                                    int dst_h) {
+  return src_w >= dst_w && src_h >= dst_h &&
+         (src_w > 2 * dst_w || src_h > 2 * dst_h);
+}
+
+#endif  // RESIZE_H
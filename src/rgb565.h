@@ -0,0 +1,459 @@
+#ifndef RGB565_H
+#define RGB565_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "image.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RGB565_X86 1
+#include <immintrin.h>
+#else
+#define RGB565_X86 0
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RGB565_NEON 1
+#include <arm_neon.h>
+#else
+#define RGB565_NEON 0
+#endif
+
+// -------------------------------------------------------
+// Convert 8-bit R,G,B → 16-bit RGB565
+// Layout: [15:11]=R, [10:5]=G, [4:0]=B
+// -------------------------------------------------------
+static inline uint16_t to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
+  uint16_t r5 = (r >> 3) & 0x1F;
+  uint16_t g6 = (g >> 2) & 0x3F;
+  uint16_t b5 = (b >> 3) & 0x1F;
+  return (uint16_t)((r5 << 11) | (g6 << 5) | b5);
+}
+
+// -------------------------------------------------------
+// Channel expansion tables, indexed by the 5/6-bit value:
+//   rgb565_exp5[x] = (x * 255) / 31
+//   rgb565_exp6[x] = (x * 255) / 63
+// from_rgb565() and with it the scalar unpack kernel and
+// every SIMD tail read these.
+// -------------------------------------------------------
+static const uint8_t rgb565_exp5[32] = {
+    0, 8, 16, 24, 32, 41, 49, 57, 65, 74, 82, 90,
+    98, 106, 115, 123, 131, 139, 148, 156, 164, 172, 180, 189,
+    197, 205, 213, 222, 230, 238, 246, 255,
+};
+
+static const uint8_t rgb565_exp6[64] = {
+    0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44,
+    48, 52, 56, 60, 64, 68, 72, 76, 80, 85, 89, 93,
+    97, 101, 105, 109, 113, 117, 121, 125, 129, 133, 137, 141,
+    145, 149, 153, 157, 161, 165, 170, 174, 178, 182, 186, 190,
+    194, 198, 202, 206, 210, 214, 218, 222, 226, 230, 234, 238,
+    242, 246, 250, 255,
+};
+
+// -------------------------------------------------------
+// Convert 16-bit RGB565 → 8-bit R,G,B
+// r8 = (r5 * 255) / 31, g8 = (g6 * 255) / 63, by table
+// -------------------------------------------------------
+static inline void from_rgb565(uint16_t p, uint8_t *rgb) {
+  rgb[0] = rgb565_exp5[(p >> 11) & 0x1F];
+  rgb[1] = rgb565_exp6[(p >> 5) & 0x3F];
+  rgb[2] = rgb565_exp5[p & 0x1F];
+}
+
+// The vector kernels use multiply-shifts instead, which
+// are exact over the 5/6-bit range (so they match the
+// tables byte for byte) and cost less than PSHUFB lookups
+// once the interleave is paid for:
+//   (x * 255) / 31 == (x * 1053) >> 7        for x in 0..31
+//   (x * 255) / 63 == (x * 259 + 3) >> 6     for x in 0..63
+#define RGB565_EXP5_MUL 1053
+#define RGB565_EXP5_SHIFT 7
+#define RGB565_EXP6_MUL 259
+#define RGB565_EXP6_ADD 3
+#define RGB565_EXP6_SHIFT 6
+
+// -------------------------------------------------------
+// Scalar kernels (reference; bit-identical to the SIMD ones)
+//
+// pack_* convert n interleaved 3-byte pixels to RGB565;
+// bgr selects BMP channel order (B, G, R) instead of the
+// Pixel order (R, G, B). unpack writes R, G, B bytes.
+// -------------------------------------------------------
+static inline void rgb565_pack_scalar(const uint8_t *src, uint16_t *dst,
+                                      size_t n, int bgr) {
+  int ri = bgr ? 2 : 0, bi = bgr ? 0 : 2;
+  for (size_t i = 0; i < n; i++) {
+    const uint8_t *p = src + i * 3;
+    dst[i] = to_rgb565(p[ri], p[1], p[bi]);
+  }
+}
+
+static inline void rgb565_unpack_scalar(const uint16_t *src, uint8_t *dst,
+                                        size_t n) {
+  for (size_t i = 0; i < n; i++) from_rgb565(src[i], dst + i * 3);
+}
+
+#if RGB565_X86
+// -------------------------------------------------------
+// x86: 48 interleaved bytes (16 pixels) <-> three 16-byte
+// channel vectors via PSHUFB. ch0 is the first byte of
+// each pixel in memory.
+// -------------------------------------------------------
+__attribute__((target("sse4.1"))) static inline void rgb565_deinterleave_x86(
+    const uint8_t *src, __m128i *ch0, __m128i *ch1, __m128i *ch2) {
+  __m128i a = _mm_loadu_si128((const __m128i *)(src + 0));
+  __m128i b = _mm_loadu_si128((const __m128i *)(src + 16));
+  __m128i c = _mm_loadu_si128((const __m128i *)(src + 32));
+  *ch0 = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(a, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1)),
+          _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8,
+                                            11, 14, -1, -1, -1, -1, -1))),
+      _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, -1, 1, 4, 7, 10, 13)));
+  *ch1 = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(a, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1)),
+          _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9,
+                                            12, 15, -1, -1, -1, -1, -1))),
+      _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, -1, 2, 5, 8, 11, 14)));
+  *ch2 = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(a, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, -1, -1)),
+          _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10,
+                                            13, -1, -1, -1, -1, -1, -1))),
+      _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                        -1, 0, 3, 6, 9, 12, 15)));
+}
+
+__attribute__((target("sse4.1"))) static inline void rgb565_interleave_x86(
+    __m128i ch0, __m128i ch1, __m128i ch2, uint8_t *dst) {
+  __m128i a = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(ch0, _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1,
+                                              3, -1, -1, 4, -1, -1, 5)),
+          _mm_shuffle_epi8(ch1, _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1,
+                                              -1, 3, -1, -1, 4, -1, -1))),
+      _mm_shuffle_epi8(ch2, _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1,
+                                          -1, 3, -1, -1, 4, -1)));
+  __m128i b = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(ch0, _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8,
+                                              -1, -1, 9, -1, -1, 10, -1)),
+          _mm_shuffle_epi8(ch1, _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1,
+                                              8, -1, -1, 9, -1, -1, 10))),
+      _mm_shuffle_epi8(ch2, _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1,
+                                          8, -1, -1, 9, -1, -1)));
+  __m128i c = _mm_or_si128(
+      _mm_or_si128(
+          _mm_shuffle_epi8(ch0, _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13,
+                                              -1, -1, 14, -1, -1, 15, -1, -1)),
+          _mm_shuffle_epi8(ch1, _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1,
+                                              13, -1, -1, 14, -1, -1, 15, -1))),
+      _mm_shuffle_epi8(ch2, _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1,
+                                          13, -1, -1, 14, -1, -1, 15)));
+  _mm_storeu_si128((__m128i *)(dst + 0), a);
+  _mm_storeu_si128((__m128i *)(dst + 16), b);
+  _mm_storeu_si128((__m128i *)(dst + 32), c);
+}
+
+// ---- SSE4.1: 16 pixels per iteration ----
+__attribute__((target("sse4.1"))) static inline void rgb565_pack_sse41(
+    const uint8_t *src, uint16_t *dst, size_t n, int bgr) {
+  const __m128i mr = _mm_set1_epi16((short)0xF800);
+  const __m128i mg = _mm_set1_epi16(0x07E0);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i c0, c1, c2;
+    rgb565_deinterleave_x86(src + i * 3, &c0, &c1, &c2);
+    __m128i r = bgr ? c2 : c0, b = bgr ? c0 : c2;
+    for (int h = 0; h < 2; h++) {
+      __m128i r16 = _mm_cvtepu8_epi16(h ? _mm_srli_si128(r, 8) : r);
+      __m128i g16 = _mm_cvtepu8_epi16(h ? _mm_srli_si128(c1, 8) : c1);
+      __m128i b16 = _mm_cvtepu8_epi16(h ? _mm_srli_si128(b, 8) : b);
+      __m128i px = _mm_or_si128(
+          _mm_or_si128(_mm_and_si128(_mm_slli_epi16(r16, 8), mr),
+                       _mm_and_si128(_mm_slli_epi16(g16, 3), mg)),
+          _mm_srli_epi16(b16, 3));
+      _mm_storeu_si128((__m128i *)(dst + i + h * 8), px);
+    }
+  }
+  rgb565_pack_scalar(src + i * 3, dst + i, n - i, bgr);
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i rgb565_expand_x86(
+    __m128i p, int ch) {
+  // ch: 0 = R, 1 = G, 2 = B; returns 8 expanded values as u16
+  if (ch == 1) {
+    __m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), _mm_set1_epi16(0x3F));
+    return _mm_srli_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(RGB565_EXP6_MUL)),
+                      _mm_set1_epi16(RGB565_EXP6_ADD)),
+        RGB565_EXP6_SHIFT);
+  }
+  __m128i c = ch == 0 ? _mm_srli_epi16(p, 11)
+                      : _mm_and_si128(p, _mm_set1_epi16(0x1F));
+  return _mm_srli_epi16(_mm_mullo_epi16(c, _mm_set1_epi16(RGB565_EXP5_MUL)),
+                        RGB565_EXP5_SHIFT);
+}
+
+__attribute__((target("sse4.1"))) static inline void rgb565_unpack_sse41(
+    const uint16_t *src, uint8_t *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i lo = _mm_loadu_si128((const __m128i *)(src + i));
+    __m128i hi = _mm_loadu_si128((const __m128i *)(src + i + 8));
+    __m128i r = _mm_packus_epi16(rgb565_expand_x86(lo, 0),
+                                 rgb565_expand_x86(hi, 0));
+    __m128i g = _mm_packus_epi16(rgb565_expand_x86(lo, 1),
+                                 rgb565_expand_x86(hi, 1));
+    __m128i b = _mm_packus_epi16(rgb565_expand_x86(lo, 2),
+                                 rgb565_expand_x86(hi, 2));
+    rgb565_interleave_x86(r, g, b, dst + i * 3);
+  }
+  rgb565_unpack_scalar(src + i, dst + i * 3, n - i);
+}
+
+// ---- AVX2: 32 pixels per iteration ----
+// Byte (de)interleave stays 128-bit (PSHUFB does not cross
+// lanes); the RGB565 arithmetic runs 16 pixels per op.
+__attribute__((target("avx2"))) static inline void rgb565_pack_avx2(
+    const uint8_t *src, uint16_t *dst, size_t n, int bgr) {
+  const __m256i mr = _mm256_set1_epi16((short)0xF800);
+  const __m256i mg = _mm256_set1_epi16(0x07E0);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    for (int h = 0; h < 2; h++) {
+      __m128i c0, c1, c2;
+      rgb565_deinterleave_x86(src + (i + h * 16) * 3, &c0, &c1, &c2);
+      __m256i r16 = _mm256_cvtepu8_epi16(bgr ? c2 : c0);
+      __m256i g16 = _mm256_cvtepu8_epi16(c1);
+      __m256i b16 = _mm256_cvtepu8_epi16(bgr ? c0 : c2);
+      __m256i px = _mm256_or_si256(
+          _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(r16, 8), mr),
+                          _mm256_and_si256(_mm256_slli_epi16(g16, 3), mg)),
+          _mm256_srli_epi16(b16, 3));
+      _mm256_storeu_si256((__m256i *)(dst + i + h * 16), px);
+    }
+  }
+  rgb565_pack_sse41(src + i * 3, dst + i, n - i, bgr);
+}
+
+__attribute__((target("avx2"))) static inline void rgb565_unpack_avx2(
+    const uint16_t *src, uint8_t *dst, size_t n) {
+  const __m256i m5 = _mm256_set1_epi16(RGB565_EXP5_MUL);
+  const __m256i m6 = _mm256_set1_epi16(RGB565_EXP6_MUL);
+  const __m256i a6 = _mm256_set1_epi16(RGB565_EXP6_ADD);
+  const __m256i k1f = _mm256_set1_epi16(0x1F);
+  const __m256i k3f = _mm256_set1_epi16(0x3F);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i lo = _mm256_loadu_si256((const __m256i *)(src + i));
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(src + i + 16));
+    for (int h = 0; h < 2; h++) {
+      __m256i p = h ? hi : lo;
+      __m256i r = _mm256_srli_epi16(
+          _mm256_mullo_epi16(_mm256_srli_epi16(p, 11), m5), RGB565_EXP5_SHIFT);
+      __m256i g = _mm256_srli_epi16(
+          _mm256_add_epi16(
+              _mm256_mullo_epi16(
+                  _mm256_and_si256(_mm256_srli_epi16(p, 5), k3f), m6),
+              a6),
+          RGB565_EXP6_SHIFT);
+      __m256i b = _mm256_srli_epi16(
+          _mm256_mullo_epi16(_mm256_and_si256(p, k1f), m5), RGB565_EXP5_SHIFT);
+      // 16 u16 → 16 u8, in pixel order
+      __m128i rr = _mm_packus_epi16(_mm256_castsi256_si128(r),
+                                    _mm256_extracti128_si256(r, 1));
+      __m128i gg = _mm_packus_epi16(_mm256_castsi256_si128(g),
+                                    _mm256_extracti128_si256(g, 1));
+      __m128i bb = _mm_packus_epi16(_mm256_castsi256_si128(b),
+                                    _mm256_extracti128_si256(b, 1));
+      rgb565_interleave_x86(rr, gg, bb, dst + (i + h * 16) * 3);
+    }
+  }
+  rgb565_unpack_sse41(src + i, dst + i * 3, n - i);
+}
+#endif  // RGB565_X86
+
+#if RGB565_NEON
+// ---- NEON: 16 pixels per iteration (VLD3/VST3 deinterleave) ----
+static inline void rgb565_pack_neon(const uint8_t *src, uint16_t *dst, size_t n,
+                             int bgr) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16x3_t v = vld3q_u8(src + i * 3);
+    uint8x16_t r = bgr ? v.val[2] : v.val[0];
+    uint8x16_t g = v.val[1];
+    uint8x16_t b = bgr ? v.val[0] : v.val[2];
+    // (r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3
+    uint16x8_t lo = vshll_n_u8(vget_low_u8(vandq_u8(r, vdupq_n_u8(0xF8))), 8);
+    uint16x8_t hi = vshll_n_u8(vget_high_u8(vandq_u8(r, vdupq_n_u8(0xF8))), 8);
+    uint8x16_t g6 = vandq_u8(g, vdupq_n_u8(0xFC));
+    lo = vorrq_u16(lo, vshll_n_u8(vget_low_u8(g6), 3));
+    hi = vorrq_u16(hi, vshll_n_u8(vget_high_u8(g6), 3));
+    uint8x16_t b5 = vshrq_n_u8(b, 3);
+    lo = vorrq_u16(lo, vmovl_u8(vget_low_u8(b5)));
+    hi = vorrq_u16(hi, vmovl_u8(vget_high_u8(b5)));
+    vst1q_u16(dst + i, lo);
+    vst1q_u16(dst + i + 8, hi);
+  }
+  rgb565_pack_scalar(src + i * 3, dst + i, n - i, bgr);
+}
+
+static inline uint8x8_t rgb565_expand5_neon(uint16x8_t c) {
+  return vmovn_u16(
+      vshrq_n_u16(vmulq_n_u16(c, RGB565_EXP5_MUL), RGB565_EXP5_SHIFT));
+}
+
+static inline void rgb565_unpack_neon(const uint16_t *src, uint8_t *dst, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint8x16x3_t o;
+    uint8x8_t r[2], g[2], b[2];
+    for (int h = 0; h < 2; h++) {
+      uint16x8_t p = vld1q_u16(src + i + h * 8);
+      r[h] = rgb565_expand5_neon(vshrq_n_u16(p, 11));
+      b[h] = rgb565_expand5_neon(vandq_u16(p, vdupq_n_u16(0x1F)));
+      uint16x8_t g6 = vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3F));
+      g[h] = vmovn_u16(vshrq_n_u16(
+          vaddq_u16(vmulq_n_u16(g6, RGB565_EXP6_MUL),
+                    vdupq_n_u16(RGB565_EXP6_ADD)),
+          RGB565_EXP6_SHIFT));
+    }
+    o.val[0] = vcombine_u8(r[0], r[1]);
+    o.val[1] = vcombine_u8(g[0], g[1]);
+    o.val[2] = vcombine_u8(b[0], b[1]);
+    vst3q_u8(dst + i * 3, o);
+  }
+  rgb565_unpack_scalar(src + i, dst + i * 3, n - i);
+}
+#endif  // RGB565_NEON
+
+// -------------------------------------------------------
+// Runtime dispatch
+//
+// The best kernel set the CPU supports is picked on first
+// use. rgb565_set_level() can force a lower level (for
+// testing and benchmarks); requests above what the CPU
+// supports are clamped.
+// -------------------------------------------------------
+typedef enum {
+  RGB565_SCALAR = 0,
+  RGB565_SSE41,
+  RGB565_AVX2,
+  RGB565_NEON_LEVEL
+} Rgb565Level;
+
+typedef void (*Rgb565PackFn)(const uint8_t *, uint16_t *, size_t, int);
+typedef void (*Rgb565UnpackFn)(const uint16_t *, uint8_t *, size_t);
+
+typedef struct {
+  Rgb565Level level;
+  Rgb565PackFn pack;
+  Rgb565UnpackFn unpack;
+} Rgb565Kernels;
+
+static inline Rgb565Level rgb565_detect_level(void) {
+#if RGB565_NEON
+  return RGB565_NEON_LEVEL;
+#elif RGB565_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return RGB565_AVX2;
+  if (__builtin_cpu_supports("sse4.1")) return RGB565_SSE41;
+  return RGB565_SCALAR;
+#else
+  return RGB565_SCALAR;
+#endif
+}
+
+// One immutable table per level. rgb565_active points at one
+// of them and is only loaded and stored atomically, so a thread
+// racing the first call (or rgb565_set_level()) sees a whole
+// table, never pack from one level and unpack from another.
+static const Rgb565Kernels rgb565_table_scalar = {
+    RGB565_SCALAR, rgb565_pack_scalar, rgb565_unpack_scalar};
+#if RGB565_X86
+static const Rgb565Kernels rgb565_table_sse41 = {
+    RGB565_SSE41, rgb565_pack_sse41, rgb565_unpack_sse41};
+static const Rgb565Kernels rgb565_table_avx2 = {
+    RGB565_AVX2, rgb565_pack_avx2, rgb565_unpack_avx2};
+#endif
+#if RGB565_NEON
+static const Rgb565Kernels rgb565_table_neon = {
+    RGB565_NEON_LEVEL, rgb565_pack_neon, rgb565_unpack_neon};
+#endif
+
+static const Rgb565Kernels *rgb565_active;
+
+// Table for level; levels not built for this target are scalar
+static inline const Rgb565Kernels *rgb565_table(Rgb565Level level) {
+  switch (level) {
+#if RGB565_X86
+    case RGB565_SSE41: return &rgb565_table_sse41;
+    case RGB565_AVX2: return &rgb565_table_avx2;
+#endif
+#if RGB565_NEON
+    case RGB565_NEON_LEVEL: return &rgb565_table_neon;
+#endif
+    default: return &rgb565_table_scalar;
+  }
+}
+
+static inline void rgb565_set_level(Rgb565Level level) {
+  Rgb565Level best = rgb565_detect_level();
+  if (level > best) level = best;
+  __atomic_store_n(&rgb565_active, rgb565_table(level), __ATOMIC_RELEASE);
+}
+
+// First use publishes the detected level, unless a
+// rgb565_set_level() got there first
+static inline const Rgb565Kernels *rgb565_kernels(void) {
+  const Rgb565Kernels *k = __atomic_load_n(&rgb565_active, __ATOMIC_ACQUIRE);
+  if (k) return k;
+  const Rgb565Kernels *want = rgb565_table(rgb565_detect_level());
+  if (__atomic_compare_exchange_n(&rgb565_active, &k, want, 0,
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    return want;
+  return k;  // the pointer another thread published
+}
+
+static inline const char *rgb565_level_name(Rgb565Level level) {
+  switch (level) {
+    case RGB565_SSE41: return "SSE4.1";
+    case RGB565_AVX2: return "AVX2";
+    case RGB565_NEON_LEVEL: return "NEON";
+    default: return "scalar";
+  }
+}
+
+// -------------------------------------------------------
+// Public entry points
+// -------------------------------------------------------
+// n Pixels (R, G, B) → n RGB565 words
+static inline void rgb565_pack_rgb(const Pixel *src, uint16_t *dst, size_t n) {
+  rgb565_kernels()->pack((const uint8_t *)src, dst, n, 0);
+}
+
+// n BMP pixels (B, G, R bytes) → n RGB565 words
+static inline void rgb565_pack_bgr(const uint8_t *src, uint16_t *dst,
+                                   size_t n) {
+  rgb565_kernels()->pack(src, dst, n, 1);
+}
+
+// n RGB565 words → 3n bytes R, G, B (PPM order)
+static inline void rgb565_unpack_rgb(const uint16_t *src, uint8_t *dst,
+                                     size_t n) {
+  rgb565_kernels()->unpack(src, dst, n);
+}
+
+#endif  // RGB565_H
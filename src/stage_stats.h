@@ -0,0 +1,152 @@
+#ifndef STAGE_STATS_H
+#define STAGE_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// -------------------------------------------------------
+// Per-stage timers for the C tools (--stats)
+//
+// Each stage adds up calls, seconds, pixels produced and
+// bytes consumed (or written, for the output stages) over
+// a run. Stages are fixed slots and every stage is timed
+// by one thread only, so the pipelined batch mode needs no
+// locking; its stages overlap, and their sum can exceed
+// the wall time. A NULL Stats skips the clock reads.
+// -------------------------------------------------------
+typedef enum {
+  STAGE_BMP_READ = 0,  // map + validate (pages fault in later, in resize)
+  STAGE_CACHE,         // --cache: hash the input + look up its entry
+  STAGE_RESIZE,
+  STAGE_PACK,         // Pixel/BGR → RGB565
+  STAGE_FUSED,        // resize + pack + blur in one pass (--blur)
+  STAGE_FRAME_WRITE,  // .hex/.bin/.raw encode + write
+  STAGE_PARSE,        // .hex/.bin/.raw read + decode
+  STAGE_EXPAND,       // RGB565 → RGB888
+  STAGE_PPM_WRITE,
+  STAGE_COUNT
+} StatsStage;
+
+static inline const char *stats_stage_name(StatsStage s) {
+  static const char *const names[STAGE_COUNT] = {
+      "bmp_read", "cache", "resize", "pack",     "fused_blur",
+      "write",    "parse", "expand", "ppm_write"};
+  return names[s];
+}
+
+typedef struct {
+  unsigned long calls;
+  double seconds;
+  uint64_t pixels, bytes;
+} StageTotals;
+
+typedef struct {
+  StageTotals stage[STAGE_COUNT];
+  double t_start;
+  unsigned long frames;
+} Stats;
+
+static inline double stats_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static inline void stats_init(Stats *s) {
+  memset(s, 0, sizeof(*s));
+  s->t_start = stats_now();
+}
+
+// Start of a timed section; 0 when not collecting
+static inline double stats_clock(const Stats *s) {
+  return s ? stats_now() : 0.0;
+}
+
+// End of a section started at t0
+static inline void stats_add(Stats *s, StatsStage st, double t0,
+                             uint64_t pixels, uint64_t bytes) {
+  if (!s) return;
+  StageTotals *x = &s->stage[st];
+  x->seconds += stats_now() - t0;
+  x->calls++;
+  x->pixels += pixels;
+  x->bytes += bytes;
+}
+
+static inline double stats_rate(uint64_t n, double seconds) {
+  return seconds > 0 ? (double)n / seconds : 0.0;
+}
+
+// Human-readable table of the stages that ran
+static inline void stats_print(const Stats *s, FILE *fp) {
+  double wall = stats_now() - s->t_start;
+  fprintf(fp, "%-11s %6s %10s %10s %10s\n", "stage", "calls", "ms",
+          "MPix/s", "MB/s");
+  for (int i = 0; i < STAGE_COUNT; i++) {
+    const StageTotals *x = &s->stage[i];
+    if (!x->calls) continue;
+    fprintf(fp, "%-11s %6lu %10.3f %10.1f %10.1f\n",
+            stats_stage_name((StatsStage)i), x->calls, x->seconds * 1e3,
+            stats_rate(x->pixels, x->seconds) * 1e-6,
+            stats_rate(x->bytes, x->seconds) * 1e-6);
+  }
+  fprintf(fp, "%-11s %6lu %10.3f   (frames, wall ms)\n", "total", s->frames,
+          wall * 1e3);
+}
+
+// One JSON object: {"tool", "frames", "wall_s", "stages": [...]}
+// with seconds, calls, pixels, bytes and both rates per stage.
+static inline int stats_write_json(const Stats *s, const char *tool,
+                                   FILE *fp) {
+  double wall = stats_now() - s->t_start;
+  fprintf(fp, "{\"tool\": \"%s\", \"frames\": %lu, \"wall_s\": %.9f, "
+              "\"stages\": [",
+          tool, s->frames, wall);
+  int first = 1;
+  for (int i = 0; i < STAGE_COUNT; i++) {
+    const StageTotals *x = &s->stage[i];
+    if (!x->calls) continue;
+    fprintf(fp,
+            "%s\n  {\"name\": \"%s\", \"calls\": %lu, \"seconds\": %.9f, "
+            "\"pixels\": %llu, \"bytes\": %llu, \"pixels_per_s\": %.1f, "
+            "\"bytes_per_s\": %.1f}",
+            first ? "" : ",", stats_stage_name((StatsStage)i), x->calls,
+            x->seconds, (unsigned long long)x->pixels,
+            (unsigned long long)x->bytes, stats_rate(x->pixels, x->seconds),
+            stats_rate(x->bytes, x->seconds));
+    first = 0;
+  }
+  return fprintf(fp, "]}\n") < 0 ? -1 : 0;
+}
+
+// Where a tool prints its progress lines and the table:
+// stdout, or stderr when --stats=- leaves stdout to the JSON
+static inline FILE *stats_log_stream(const char *json_path) {
+  return json_path && strcmp(json_path, "-") == 0 ? stderr : stdout;
+}
+
+// --stats report: the table on stdout, plus the JSON to
+// json_path when one was given. With json_path "-" the JSON
+// goes to stdout and the table to stderr. Returns 0, or -1
+// if the JSON could not be written.
+static inline int stats_report(const Stats *s, const char *tool,
+                               const char *json_path) {
+  int json_stdout = json_path && strcmp(json_path, "-") == 0;
+  stats_print(s, stats_log_stream(json_path));
+  if (!json_path) return 0;
+  if (json_stdout) return stats_write_json(s, tool, stdout);
+  FILE *fp = fopen(json_path, "w");
+  if (!fp) {
+    perror(json_path);
+    return -1;
+  }
+  int err = stats_write_json(s, tool, fp);
+  if (fclose(fp) != 0) err = -1;
+  if (err) fprintf(stderr, "Error: failed writing %s\n", json_path);
+  return err;
+}
+
+#endif  // STAGE_STATS_H
@@ -0,0 +1,162 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// -------------------------------------------------------
+// Fixed-size worker pool that runs one job at a time over
+// horizontal bands of a frame. The calling thread works as
+// worker 0, so a pool of 1 runs everything inline with no
+// threads. Bands are handed out dynamically (several per
+// worker) to even out load. Build with -pthread.
+// -------------------------------------------------------
+typedef void (*BandFn)(void *ctx, int y_begin, int y_end, int worker);
+
+typedef struct {
+  int nthreads;
+  pthread_t *threads;
+  pthread_mutex_t mu;
+  pthread_cond_t cv_job;
+  pthread_cond_t cv_done;
+  // current job
+  BandFn fn;
+  void *ctx;
+  int rows, band_rows, nbands, next_band;
+  int busy;          // helper threads still on this job
+  unsigned job_id;   // bumped per job; helpers wait for a change
+  int quit;
+} ThreadPool;
+
+typedef struct {
+  ThreadPool *pool;
+  int worker;
+} ThreadPoolArg;
+
+// Number of online CPUs (at least 1)
+static inline int thread_pool_cpu_count(void) {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+}
+
+static inline void thread_pool_drain(ThreadPool *p, int worker) {
+  for (;;) {
+    pthread_mutex_lock(&p->mu);
+    int b = p->next_band < p->nbands ? p->next_band++ : -1;
+    pthread_mutex_unlock(&p->mu);
+    if (b < 0) return;
+    int y0 = b * p->band_rows;
+    int y1 = y0 + p->band_rows < p->rows ? y0 + p->band_rows : p->rows;
+    p->fn(p->ctx, y0, y1, worker);
+  }
+}
+
+static inline void *thread_pool_main(void *arg) {
+  ThreadPoolArg *a = (ThreadPoolArg *)arg;
+  ThreadPool *p = a->pool;
+  int worker = a->worker;
+  free(a);
+
+  unsigned seen = 0;
+  pthread_mutex_lock(&p->mu);
+  for (;;) {
+    while (!p->quit && p->job_id == seen) pthread_cond_wait(&p->cv_job, &p->mu);
+    if (p->quit) break;
+    seen = p->job_id;
+    pthread_mutex_unlock(&p->mu);
+
+    thread_pool_drain(p, worker);
+
+    pthread_mutex_lock(&p->mu);
+    if (--p->busy == 0) pthread_cond_signal(&p->cv_done);
+  }
+  pthread_mutex_unlock(&p->mu);
+  return NULL;
+}
+
+static inline void thread_pool_destroy(ThreadPool *p) {
+  if (!p) return;
+  pthread_mutex_lock(&p->mu);
+  p->quit = 1;
+  pthread_cond_broadcast(&p->cv_job);
+  pthread_mutex_unlock(&p->mu);
+  for (int i = 1; i < p->nthreads; i++) pthread_join(p->threads[i], NULL);
+  pthread_cond_destroy(&p->cv_job);
+  pthread_cond_destroy(&p->cv_done);
+  pthread_mutex_destroy(&p->mu);
+  free(p->threads);
+  free(p);
+}
+
+// nthreads <= 0 means one per online CPU. Returns NULL on failure.
+static inline ThreadPool *thread_pool_create(int nthreads) {
+  if (nthreads <= 0) nthreads = thread_pool_cpu_count();
+  ThreadPool *p = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+  if (!p) return NULL;
+  p->threads = (pthread_t *)calloc((size_t)nthreads, sizeof(pthread_t));
+  if (!p->threads) {
+    free(p);
+    return NULL;
+  }
+  pthread_mutex_init(&p->mu, NULL);
+  pthread_cond_init(&p->cv_job, NULL);
+  pthread_cond_init(&p->cv_done, NULL);
+  p->nthreads = 1;
+  for (int i = 1; i < nthreads; i++) {
+    ThreadPoolArg *a = (ThreadPoolArg *)malloc(sizeof(ThreadPoolArg));
+    if (!a) break;
+    a->pool = p;
+    a->worker = i;
+    if (pthread_create(&p->threads[i], NULL, thread_pool_main, a) != 0) {
+      free(a);
+      break;
+    }
+    p->nthreads++;
+  }
+  return p;
+}
+
+// -------------------------------------------------------
+// Run fn over rows [0, rows) split into bands of at least
+// min_rows rows, and wait for all of them. fn may run on
+// any worker; worker is in [0, nthreads) and can index
+// per-worker scratch.
+// -------------------------------------------------------
+static inline void thread_pool_run_bands(ThreadPool *p, int rows, int min_rows,
+                                         BandFn fn, void *ctx) {
+  if (rows <= 0) return;
+  if (!p || p->nthreads == 1) {
+    fn(ctx, 0, rows, 0);
+    return;
+  }
+  if (min_rows < 1) min_rows = 1;
+  int nbands = p->nthreads * 4;
+  int band_rows = (rows + nbands - 1) / nbands;
+  if (band_rows < min_rows) band_rows = min_rows;
+
+  pthread_mutex_lock(&p->mu);
+  p->fn = fn;
+  p->ctx = ctx;
+  p->rows = rows;
+  p->band_rows = band_rows;
+  p->nbands = (rows + band_rows - 1) / band_rows;
+  p->next_band = 0;
+  p->busy = p->nthreads - 1;
+  p->job_id++;
+  pthread_cond_broadcast(&p->cv_job);
+  pthread_mutex_unlock(&p->mu);
+
+  thread_pool_drain(p, 0);
+
+  pthread_mutex_lock(&p->mu);
+  while (p->busy > 0) pthread_cond_wait(&p->cv_done, &p->mu);
+  pthread_mutex_unlock(&p->mu);
+}
+
+static inline int thread_pool_size(const ThreadPool *p) {
+  return p ? p->nthreads : 1;
+}
+
+#endif  // THREAD_POOL_H
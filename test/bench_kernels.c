@@ -0,0 +1,405 @@
+// Microbenchmarks for the C pixel kernels.
+//
+// Times the resize engines (float reference, fixed-point, fixed-point
+// on planes, area), RGB565 pack and expand and the hex writer at every
+// SIMD level the CPU has (plus the per-pixel to_rgb565()/from_rgb565()
+// helpers), hex parsing (parse_rgb565_line() per line and the hex
+// scanner) and the blur models, on synthetic frames of each size. Reports
+// ns per pixel (median and best of --reps timed runs, after --warmup
+// untimed ones) and the MPix/s of the median.
+//
+// Resize cases map a frame of the listed size to --dst (default
+// 320x240, what bmp_to_hex writes) and count output pixels; every
+// other case works on the listed size itself.
+//
+// Build (from the repo root):
+//   cc -O2 -o bench_kernels test/bench_kernels.c -pthread -lm
+// Run:
+//   ./bench_kernels [--sizes=WxH,WxH,...] [--dst=WxH] [--warmup=N]
+//                   [--reps=N] [--filter=SUBSTR]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/frame_io.h"
+#include "../src/frame_pool.h"
+#include "../src/gauss_blur.h"
+#include "../src/gauss_kernel.h"
+#include "../src/planar.h"
+#include "../src/resize.h"
+#include "../src/rgb565.h"
+#include "../src/stage_stats.h"
+
+#define BENCH_MAX_SIZES 16
+#define BENCH_MAX_REPS 1000
+
+// -------------------------------------------------------
+// One frame size and everything the cases read and write
+// -------------------------------------------------------
+typedef struct {
+  int w, h, dst_w, dst_h;
+  uint8_t *bgr;  // BMP-style BGR rows, 4-byte aligned stride
+  BgrView src;
+  Pixel *rgb;        // w x h, unpacked source for the pack cases
+  Pixel *resized;    // dst_w x dst_h
+  uint16_t *frame;   // w x h RGB565 source for blur/expand/hex
+  uint16_t *out;     // w x h result
+  uint8_t *rgb888;   // 3 x w x h
+  char *hex;         // frame as "XXXX\n" lines
+  size_t hex_len;
+  FILE *null_out;    // hex writer target
+  ResizeTables tables;
+  AreaTables area;
+  int have_area;
+  uint16_t *resize_rows;
+  uint32_t *area_acc;
+  PlanarImage psrc, pdst, pa, pb;
+  uint8_t *plane_v;
+  GaussKernel k5;
+  uint16_t *ring;
+  uint32_t *kring;
+  FramePool bufs;
+} Frame;
+
+static int frame_setup(Frame *f, int w, int h, int dst_w, int dst_h) {
+  memset(f, 0, sizeof(*f));
+  f->w = w;
+  f->h = h;
+  f->dst_w = dst_w;
+  f->dst_h = dst_h;
+  size_t n = (size_t)w * h;
+  size_t stride = ((size_t)w * 3 + 3) & ~(size_t)3;
+  frame_pool_init(&f->bufs);
+  f->bgr = (uint8_t *)malloc(stride * h);
+  f->rgb = (Pixel *)malloc(n * sizeof(Pixel));
+  f->resized = (Pixel *)malloc((size_t)dst_w * dst_h * sizeof(Pixel));
+  f->frame = (uint16_t *)malloc(n * sizeof(uint16_t));
+  f->out = (uint16_t *)malloc(n * sizeof(uint16_t));
+  f->rgb888 = (uint8_t *)malloc(n * 3);
+  f->hex = (char *)malloc(n * 5 + 1);
+  f->plane_v = (uint8_t *)malloc((size_t)w);
+  f->ring = (uint16_t *)malloc(gauss_ring_words(w) * sizeof(uint16_t));
+  gauss_kernel_binomial(&f->k5, 2);
+  f->kring =
+      (uint32_t *)malloc(gauss_kernel_ring_words(&f->k5, w) * sizeof(uint32_t));
+  f->null_out = fopen("/dev/null", "w");
+  if (!f->bgr || !f->rgb || !f->resized || !f->frame || !f->out ||
+      !f->rgb888 || !f->hex || !f->plane_v || !f->ring || !f->kring ||
+      !f->null_out)
+    return -1;
+  if (resize_tables_init(&f->tables, w, h, dst_w, dst_h) != 0) return -1;
+  f->resize_rows =
+      (uint16_t *)malloc(resize_rows_words(&f->tables) * sizeof(uint16_t));
+  if (!f->resize_rows) return -1;
+  if (w >= dst_w && h >= dst_h &&
+      area_tables_init(&f->area, w, h, dst_w, dst_h) == 0) {
+    f->have_area = 1;
+    f->area_acc =
+        (uint32_t *)malloc(resize_area_words(&f->area) * sizeof(uint32_t));
+    if (!f->area_acc) return -1;
+  }
+  if (planar_init(&f->psrc, w, h) != 0 ||
+      planar_init(&f->pdst, dst_w, dst_h) != 0 ||
+      planar_init(&f->pa, w, h) != 0 || planar_init(&f->pb, w, h) != 0)
+    return -1;
+
+  // Smooth gradients plus noise, so no kernel sees a flat frame
+  uint32_t seed = 12345;
+  for (int y = 0; y < h; y++) {
+    uint8_t *row = f->bgr + stride * y;
+    for (int x = 0; x < w; x++) {
+      seed = seed * 1103515245u + 12345u;
+      uint8_t noise = (uint8_t)(seed >> 24) & 31;
+      row[3 * x + 0] = (uint8_t)(x * 255 / w + noise);
+      row[3 * x + 1] = (uint8_t)(y * 255 / h + noise);
+      row[3 * x + 2] = (uint8_t)((x + y) + noise);
+    }
+  }
+  f->src.row0 = f->bgr;
+  f->src.stride = (ptrdiff_t)stride;
+  f->src.w = w;
+  f->src.h = h;
+  for (int y = 0; y < h; y++) {
+    const uint8_t *row = bgr_row(&f->src, y);
+    for (int x = 0; x < w; x++) {
+      Pixel *p = &f->rgb[(size_t)y * w + x];
+      p->r = row[3 * x + 2];
+      p->g = row[3 * x + 1];
+      p->b = row[3 * x + 0];
+      f->frame[(size_t)y * w + x] = to_rgb565(p->r, p->g, p->b);
+    }
+  }
+  for (size_t i = 0; i < n; i++)
+    snprintf(f->hex + 5 * i, 6, "%04X\n", f->frame[i]);
+  f->hex_len = n * 5;
+  planar_from_bgr(&f->src, &f->psrc);
+  planar_split_rgb565(f->frame, &f->pa);
+  return 0;
+}
+
+static void frame_teardown(Frame *f) {
+  free(f->bgr);
+  free(f->rgb);
+  free(f->resized);
+  free(f->frame);
+  free(f->out);
+  free(f->rgb888);
+  free(f->hex);
+  free(f->plane_v);
+  free(f->ring);
+  free(f->kring);
+  free(f->resize_rows);
+  free(f->area_acc);
+  if (f->null_out) fclose(f->null_out);
+  if (f->tables.x0) resize_tables_free(&f->tables);
+  if (f->have_area) area_tables_free(&f->area);
+  planar_free(&f->psrc);
+  planar_free(&f->pdst);
+  planar_free(&f->pa);
+  planar_free(&f->pb);
+  frame_pool_destroy(&f->bufs);
+}
+
+// -------------------------------------------------------
+// Cases
+// -------------------------------------------------------
+static void case_resize_float(Frame *f) {
+  resize_bilinear_rows(&f->src, f->resized, f->dst_w, f->dst_h, 0, f->dst_h);
+}
+
+static void case_resize_fixed(Frame *f) {
+  resize_bilinear_fixed_rows(&f->tables, &f->src, f->resized, 0, f->dst_h,
+                             f->resize_rows);
+}
+
+static void case_resize_planar(Frame *f) {
+  resize_bilinear_fixed_planar(&f->bufs, &f->tables, &f->psrc, &f->pdst);
+}
+
+static void case_resize_area(Frame *f) {
+  resize_area_rows(&f->area, &f->src, f->resized, 0, f->dst_h, f->area_acc);
+}
+
+static void case_to_rgb565(Frame *f) {
+  size_t n = (size_t)f->w * f->h;
+  for (size_t i = 0; i < n; i++)
+    f->out[i] = to_rgb565(f->rgb[i].r, f->rgb[i].g, f->rgb[i].b);
+}
+
+static void case_pack(Frame *f) {
+  rgb565_pack_rgb(f->rgb, f->out, (size_t)f->w * f->h);
+}
+
+static void case_pack_bgr(Frame *f) {
+  for (int y = 0; y < f->h; y++)
+    rgb565_pack_bgr(bgr_row(&f->src, y), f->out + (size_t)y * f->w, f->w);
+}
+
+static void case_from_rgb565(Frame *f) {
+  size_t n = (size_t)f->w * f->h;
+  for (size_t i = 0; i < n; i++) from_rgb565(f->frame[i], f->rgb888 + 3 * i);
+}
+
+static void case_expand(Frame *f) {
+  rgb565_unpack_rgb(f->frame, f->rgb888, (size_t)f->w * f->h);
+}
+
+static void case_parse_line(Frame *f) {
+  size_t n = (size_t)f->w * f->h;
+  for (size_t i = 0; i < n; i++) parse_rgb565_line(f->hex + 5 * i, &f->out[i]);
+}
+
+static void case_hex_scan(Frame *f) {
+  HexScanner s;
+  hex_scanner_init(&s);
+  size_t used;
+  hex_scan(&s, f->hex, f->hex_len, f->out, (size_t)f->w * f->h, &used);
+}
+
+static void case_hex_write(Frame *f) {
+  write_frame_hex(f->null_out, f->frame, (size_t)f->w * f->h);
+  fflush(f->null_out);
+}
+
+static void case_blur3(Frame *f) {
+  gauss_blur_rgb565_rows(f->frame, f->out, f->w, f->h, 0, f->h, f->ring);
+}
+
+static void case_blur5(Frame *f) {
+  gauss_blur_rgb565_kernel_rows(&f->k5, f->frame, f->out, f->w, f->h, 0, f->h,
+                                f->kring);
+}
+
+static void case_blur3_planes(Frame *f) {
+  for (int c = 0; c < 3; c++)
+    gauss_blur_plane(f->pa.plane[c], f->pb.plane[c], f->w, f->h, f->pa.stride,
+                     f->plane_v);
+}
+
+static void case_blur3_planar(Frame *f) {
+  planar_split_rgb565(f->frame, &f->pa);
+  case_blur3_planes(f);
+  planar_join_rgb565(&f->pb, f->out);
+}
+
+typedef void (*CaseFn)(Frame *f);
+
+typedef struct {
+  const char *name;
+  CaseFn fn;
+  int per_dst;    // counts the --dst pixels (resize cases)
+  int levels;     // run once per RGB565 SIMD level
+  int need_area;  // needs a geometry the area filter takes
+} BenchCase;
+
+static const BenchCase kCases[] = {
+    {"resize_float", case_resize_float, 1, 0, 0},
+    {"resize_fixed", case_resize_fixed, 1, 0, 0},
+    {"resize_fixed_planar", case_resize_planar, 1, 0, 0},
+    {"resize_area", case_resize_area, 1, 0, 1},
+    {"to_rgb565", case_to_rgb565, 0, 0, 0},
+    {"pack_rgb", case_pack, 0, 1, 0},
+    {"pack_bgr", case_pack_bgr, 0, 1, 0},
+    {"from_rgb565", case_from_rgb565, 0, 0, 0},
+    {"expand_rgb888", case_expand, 0, 1, 0},
+    {"parse_rgb565_line", case_parse_line, 0, 0, 0},
+    {"hex_scan", case_hex_scan, 0, 0, 0},
+    {"hex_write", case_hex_write, 0, 1, 0},
+    {"blur_3x3", case_blur3, 0, 0, 0},
+    {"blur_5x5", case_blur5, 0, 0, 0},
+    {"blur_3x3_planes", case_blur3_planes, 0, 0, 0},
+    {"blur_3x3_planar", case_blur3_planar, 0, 0, 0},
+};
+
+// -------------------------------------------------------
+// Timing
+// -------------------------------------------------------
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return x < y ? -1 : x > y;
+}
+
+static void run_case(Frame *f, const char *name, CaseFn fn, uint64_t pixels,
+                     int warmup, int reps) {
+  static double t[BENCH_MAX_REPS];
+  for (int i = 0; i < warmup; i++) fn(f);
+  for (int i = 0; i < reps; i++) {
+    double t0 = stats_now();
+    fn(f);
+    t[i] = stats_now() - t0;
+  }
+  qsort(t, (size_t)reps, sizeof(double), cmp_double);
+  double med = t[reps / 2], best = t[0];
+  char size[32];
+  snprintf(size, sizeof(size), "%dx%d", f->w, f->h);
+  printf("%-26s %10s %10.3f %10.3f %10.1f\n", name, size,
+         med * 1e9 / (double)pixels, best * 1e9 / (double)pixels,
+         (double)pixels / med * 1e-6);
+  fflush(stdout);
+}
+
+static int parse_sizes(const char *s, int *w, int *h, int max) {
+  int n = 0;
+  char buf[32];
+  while (*s) {
+    size_t len = strcspn(s, ",");
+    if (len == 0 || len >= sizeof(buf) || n == max) return -1;
+    memcpy(buf, s, len);
+    buf[len] = '\0';
+    if (parse_geometry(buf, &w[n], &h[n]) != 0) return -1;
+    n++;
+    s += len;
+    if (*s == ',') s++;
+  }
+  return n;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [--sizes=WxH,WxH,...] [--dst=WxH] [--warmup=N] "
+          "[--reps=N] [--filter=SUBSTR]\n",
+          prog);
+  fprintf(stderr,
+          "  defaults: --sizes=320x240,640x480,1920x1080,3840x2160 "
+          "--dst=320x240 --warmup=2 --reps=15\n");
+}
+
+int main(int argc, char *argv[]) {
+  int sw[BENCH_MAX_SIZES], sh[BENCH_MAX_SIZES];
+  int nsizes = parse_sizes("320x240,640x480,1920x1080,3840x2160", sw, sh,
+                           BENCH_MAX_SIZES);
+  int dst_w = FRAME_DEFAULT_WIDTH, dst_h = FRAME_DEFAULT_HEIGHT;
+  int warmup = 2, reps = 15;
+  const char *filter = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--sizes=", 8) == 0) {
+      nsizes = parse_sizes(argv[i] + 8, sw, sh, BENCH_MAX_SIZES);
+      if (nsizes <= 0) {
+        fprintf(stderr, "Bad --sizes (expected WxH,WxH,...): %s\n",
+                argv[i] + 8);
+        return 1;
+      }
+    } else if (strncmp(argv[i], "--dst=", 6) == 0) {
+      if (parse_geometry(argv[i] + 6, &dst_w, &dst_h) != 0) {
+        fprintf(stderr, "Bad --dst (expected WxH): %s\n", argv[i] + 6);
+        return 1;
+      }
+    } else if (strncmp(argv[i], "--warmup=", 9) == 0) {
+      warmup = atoi(argv[i] + 9);
+    } else if (strncmp(argv[i], "--reps=", 7) == 0) {
+      reps = atoi(argv[i] + 7);
+    } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (warmup < 0 || reps < 1 || reps > BENCH_MAX_REPS) {
+    fprintf(stderr, "--warmup must be >= 0 and --reps in 1..%d\n",
+            BENCH_MAX_REPS);
+    return 1;
+  }
+
+  Rgb565Level best = rgb565_detect_level();
+  printf("RGB565 kernels: up to %s; resize to %dx%d; %d warmup, %d reps\n",
+         rgb565_level_name(best), dst_w, dst_h, warmup, reps);
+  printf("%-26s %10s %10s %10s %10s\n", "case", "size", "ns/px med",
+         "ns/px min", "MPix/s");
+
+  int rc = 0;
+  for (int s = 0; s < nsizes; s++) {
+    Frame f;
+    if (frame_setup(&f, sw[s], sh[s], dst_w, dst_h) != 0) {
+      fprintf(stderr, "Setup failed for %dx%d\n", sw[s], sh[s]);
+      frame_teardown(&f);
+      rc = 1;
+      continue;
+    }
+    for (size_t c = 0; c < sizeof(kCases) / sizeof(kCases[0]); c++) {
+      const BenchCase *bc = &kCases[c];
+      if (filter && !strstr(bc->name, filter)) continue;
+      if (bc->need_area && !f.have_area) continue;
+      uint64_t pixels =
+          bc->per_dst ? (uint64_t)dst_w * dst_h : (uint64_t)f.w * f.h;
+      if (!bc->levels) {
+        run_case(&f, bc->name, bc->fn, pixels, warmup, reps);
+        continue;
+      }
+      for (int l = RGB565_SCALAR; l <= (int)best; l++) {
+        rgb565_set_level((Rgb565Level)l);
+        if ((int)rgb565_kernels()->level != l) continue;  // not on this CPU
+        char name[64];
+        snprintf(name, sizeof(name), "%s/%s", bc->name,
+                 rgb565_level_name((Rgb565Level)l));
+        run_case(&f, name, bc->fn, pixels, warmup, reps);
+      }
+      rgb565_set_level(best);
+    }
+    frame_teardown(&f);
+  }
+  return rc;
+}
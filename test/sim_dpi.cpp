@@ -0,0 +1,194 @@
+// In-process BMP -> blur -> PPM flow through the simulator.
+//
+// Each input BMP is decoded and resized by the bmp_to_hex converter
+// (src/converter.h) into a C buffer, which gaussian_blur_rgb565_320x240
+// pulls into frame_buffer over DPI-C when it sees start (GS_DPI build).
+// When the core finishes it pushes blur_buffer back, and the result
+// goes straight to convert's PPM writer (src/ppm.h). No output.hex or
+// blurred.hex is written or parsed.
+//
+// Build (from the repo root, one command; W/H/PPC must match):
+//   verilator --cc --exe --build -O3 --timing +define+GS_DPI
+//     --top-module gaussian_blur_rgb565_320x240 --prefix Vgs
+//     -GW=320 -GH=240 -GPPC=1 -CFLAGS "-O2 -DSIM_W=320 -DSIM_H=240"
+//     -LDFLAGS -pthread -Mdir sim_dpi src/gs.v test/sim_dpi.cpp
+// Run:
+//   ./sim_dpi/Vgs [--float] [--check] in.bmp out.ppm [in2.bmp out2.ppm ...]
+// --check also compares every frame against gauss_blur_rgb565().
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Vgs.h"
+#include "Vgs__Dpi.h"
+#include "verilated.h"
+
+#include "../src/bmp_image.h"
+#include "../src/converter.h"
+#include "../src/frame_pool.h"
+#include "../src/gauss_blur.h"
+#include "../src/ppm.h"
+
+#ifndef SIM_W
+#define SIM_W 320
+#endif
+#ifndef SIM_H
+#define SIM_H 240
+#endif
+
+namespace {
+
+constexpr int kW = SIM_W;
+constexpr int kH = SIM_H;
+constexpr int kN = kW * kH;
+
+// Buffers the DPI calls below read from and write to
+uint16_t g_in[kN];
+uint16_t g_out[kN];
+
+void usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [--float] [--check] in.bmp out.ppm [in.bmp out.ppm ...]\n",
+          prog);
+}
+
+void tick(Vgs *top) {
+  top->clk = 1;
+  top->eval();
+  top->clk = 0;
+  top->eval();
+}
+
+}  // namespace
+
+// -------------------------------------------------------
+// DPI-C imports of gs.v (GS_DPI)
+// -------------------------------------------------------
+int gs_dpi_get_pixel(int idx) {
+  return (idx >= 0 && idx < kN) ? g_in[idx] : 0;
+}
+
+void gs_dpi_put_pixel(int idx, int pixel) {
+  if (idx >= 0 && idx < kN) g_out[idx] = (uint16_t)pixel;
+}
+
+int main(int argc, char **argv) {
+  ResizeMode resize_mode = RESIZE_AUTO;
+  int check = 0;
+  std::vector<const char *> paths;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--float") == 0) {
+      resize_mode = RESIZE_FLOAT;
+    } else if (strcmp(argv[i], "--check") == 0) {
+      check = 1;
+    } else if (argv[i][0] == '+') {
+      // +verilator+... plusargs, handled by the context
+    } else if (argv[i][0] == '-') {
+      usage(argv[0]);
+      return 1;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty() || paths.size() % 2 != 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // Resize scratch and PPM images are reused frame to frame
+  FramePool bufs;
+  frame_pool_init(&bufs);
+  Converter conv;
+  memset(&conv, 0, sizeof(conv));
+  conv.bufs = &bufs;
+  conv.out_w = kW;
+  conv.out_h = kH;
+  conv.mode = resize_mode;
+  std::vector<Pixel> scratch(kN);
+  std::vector<uint16_t> ref(check ? kN : 0);
+
+  const std::unique_ptr<VerilatedContext> ctx{new VerilatedContext};
+  ctx->commandArgs(argc, argv);
+  const std::unique_ptr<Vgs> top{new Vgs{ctx.get()}};
+
+  top->clk = 0;
+  top->rst = 1;
+  top->start = 0;
+  for (int i = 0; i < 4; ++i) tick(top.get());
+  top->rst = 0;
+
+  int rc = 0;
+  for (size_t f = 0; f < paths.size(); f += 2) {
+    const char *in_path = paths[f];
+    const char *out_path = paths[f + 1];
+
+    BmpImage bmp;
+    if (bmp_open(in_path, &bmp) != 0) {
+      rc = 1;
+      continue;
+    }
+    int err = converter_run(&conv, &bmp.view, scratch.data(), g_in);
+    bmp_close(&bmp);
+    if (err) {
+      fprintf(stderr, "Resize failed: %s\n", in_path);
+      rc = 1;
+      continue;
+    }
+
+    // One start pulse; the core fetches g_in on this edge and
+    // hands back g_out on the edge that raises done
+    const auto t0 = std::chrono::steady_clock::now();
+    top->start = 1;
+    tick(top.get());
+    top->start = 0;
+    uint64_t cycles = 1;
+    const uint64_t max_cycles = 4ull * kN + 64;
+    while (!top->done && cycles < max_cycles && !ctx->gotFinish()) {
+      tick(top.get());
+      ++cycles;
+    }
+    const double wall =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+            .count();
+    if (!top->done) {
+      fprintf(stderr, "%s: no done after %llu cycles\n", in_path,
+              (unsigned long long)cycles);
+      rc = 1;
+      break;
+    }
+    tick(top.get());  // let done drop before the next start
+
+    if (check) {
+      if (gauss_blur_rgb565(g_in, ref.data(), kW, kH) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        rc = 1;
+        break;
+      }
+      long bad = 0;
+      for (int i = 0; i < kN; ++i) bad += g_out[i] != ref[i];
+      if (bad) {
+        fprintf(stderr, "%s: %ld pixels differ from gauss_blur_rgb565()\n",
+                in_path, bad);
+        rc = 1;
+      }
+    }
+
+    if (write_ppm_rgb565(&bufs, NULL, out_path, g_out, kW, kH) != 0) {
+      rc = 1;
+      continue;
+    }
+    printf("%s -> %s (%llu cycles, %.3f s)\n", in_path, out_path,
+           (unsigned long long)cycles, wall);
+  }
+
+  top->final();
+  converter_free(&conv);
+  frame_pool_destroy(&bufs);
+  return rc;
+}
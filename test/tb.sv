@@ -0,0 +1,317 @@
+// ============================================================
+// CI testbench (top "tb"): streams FRAMES synthetic frames through
+// gaussian_blur_rgb565_axis straight from memory, checks every pixel
+// against a behavioural 3x3 reference and reports
+//   - cycles per frame (output SOF to output SOF, steady state)
+//   - pixels per clock over the whole run
+//   - latency, first input beat to first output beat
+// The same frames also go through gaussian_blur_rgb565_320x240 (gs.v)
+// in NCFG PPC / ADD_PIPE / BORDER configurations, loaded into and read
+// back from its frame buffers hierarchically and checked against the
+// same reference with that border mode. Any mismatch or a stall past
+// MAX_CYCLES ends the run with $fatal.
+// No hex files are read or written. The Verilator C++ harness
+// (test/sim_axis.cpp) reports the same figures plus wall-time for
+// full-size frames.
+// ============================================================
+
+`timescale 1ns/1ps
+
+module tb;
+
+    // Small frame keeps the CI waveform manageable
+    parameter integer W = 32;
+    parameter integer H = 24;
+    parameter integer FRAMES = 3;
+    parameter integer GAPS = 0;     // 1: ~75% duty on both sides
+    localparam integer N = W*H;
+    localparam integer TAW = $clog2(FRAMES*N);  // stimulus/golden index
+    // Watchdog: a frame takes about N+W clocks; GAPS can cost up to ~2x
+    // on each side, so 4x plus slack only trips when the DUT stalls
+    localparam integer MAX_CYCLES = 4*FRAMES*(N + 2*W) + 1000;
+
+    reg clk = 0;
+    reg rst = 1;
+
+    always #5 clk = ~clk; // 100 MHz
+
+    initial begin
+        $dumpfile("sim_out/wave.vcd");
+        $dumpvars(0, tb);
+    end
+
+    // ----------------------------
+    // Stimulus and reference
+    // ----------------------------
+    reg [15:0] frame_buffer [0:FRAMES*N-1];
+    reg [15:0] golden       [0:FRAMES*N-1];
+
+    // Behavioural model in plain integer arithmetic; it is not the
+    // DUT, so its width mixing is waived rather than sized
+    /* verilator lint_off WIDTH */
+
+    // Edge handling, as gs.v BORDER
+    localparam integer BORDER_PASS      = 0;
+    localparam integer BORDER_REPLICATE = 1;
+    localparam integer BORDER_MIRROR    = 2;
+    localparam integer BORDER_ZERO      = 3;
+
+    // Pixel (x,y) of frame f; taps outside the frame follow bm
+    // (replicate clamps, mirror reflects without repeating the edge)
+    function automatic [15:0] ref_tap(input integer f, input integer x,
+                                      input integer y, input integer bm);
+        integer cx, cy;
+        begin
+            cx = x; cy = y;
+            if (bm == BORDER_MIRROR) begin
+                if (cx < 0) cx = -cx;
+                if (cx > W-1) cx = 2*(W-1) - cx;
+                if (cy < 0) cy = -cy;
+                if (cy > H-1) cy = 2*(H-1) - cy;
+            end else begin
+                cx = cx < 0 ? 0 : (cx > W-1 ? W-1 : cx);
+                cy = cy < 0 ? 0 : (cy > H-1 ? H-1 : cy);
+            end
+            if (bm == BORDER_ZERO && (cx != x || cy != y))
+                ref_tap = 16'h0000;
+            else
+                ref_tap = frame_buffer[f*N + cy*W + cx];
+        end
+    endfunction
+
+    // Interior is 1-2-1 / 2-4-2 / 1-2-1, >>4; with BORDER_PASS the
+    // edge pixels pass through, otherwise they blur filled taps
+    function automatic [15:0] ref_pixel(input integer f, input integer x,
+                                        input integer y, input integer bm);
+        integer dx, dy, k, r, g, b;
+        reg [15:0] p;
+        begin
+            if (bm == BORDER_PASS && (x == 0 || y == 0 || x == W-1 || y == H-1)) begin
+                ref_pixel = frame_buffer[f*N + y*W + x];
+            end else begin
+                r = 0; g = 0; b = 0;
+                for (dy = -1; dy <= 1; dy = dy + 1)
+                    for (dx = -1; dx <= 1; dx = dx + 1) begin
+                        k = (dx == 0 ? 2 : 1) * (dy == 0 ? 2 : 1);
+                        p = ref_tap(f, x+dx, y+dy, bm);
+                        r = r + k * p[15:11];
+                        g = g + k * p[10:5];
+                        b = b + k * p[4:0];
+                    end
+                ref_pixel = {r[8:4], g[9:4], b[8:4]};
+            end
+        end
+    endfunction
+
+    integer i, f, px, py;
+    reg [31:0] lcg;
+
+    initial begin
+        lcg = 32'h1234_5678;
+        for (i = 0; i < FRAMES*N; i = i + 1) begin
+            lcg = lcg * 32'd1664525 + 32'd1013904223;
+            frame_buffer[i] = lcg[31:16];
+        end
+        for (f = 0; f < FRAMES; f = f + 1)
+            for (py = 0; py < H; py = py + 1)
+                for (px = 0; px < W; px = px + 1)
+                    golden[f*N + py*W + px] = ref_pixel(f, px, py, BORDER_PASS);
+    end
+
+    /* verilator lint_on WIDTH */
+
+    // ----------------------------
+    // DUT
+    // ----------------------------
+    integer in_idx  = 0;  // beats sent, over all frames
+    integer out_idx = 0;  // beats received, over all frames
+    integer errors  = 0;
+
+    // Sized views of the beat counters for indexing the memories
+    wire [TAW-1:0] in_addr  = (in_idx < FRAMES*N) ? in_idx[TAW-1:0] : {TAW{1'b0}};
+    wire [TAW-1:0] out_addr = out_idx[TAW-1:0];
+
+    reg  s_valid = 0;
+    reg  m_ready = 0;
+    wire s_ready;
+    wire [15:0] m_data;
+    wire m_valid, m_user, m_last;
+
+    gaussian_blur_rgb565_axis #(
+        .W(W),
+        .H(H)
+    ) dut (
+        .clk(clk),
+        .rst(rst),
+        .s_axis_tdata(frame_buffer[in_addr]),
+        .s_axis_tvalid(s_valid),
+        .s_axis_tready(s_ready),
+        .s_axis_tuser(in_idx % N == 0),
+        .s_axis_tlast(in_idx % W == W-1),
+        .m_axis_tdata(m_data),
+        .m_axis_tvalid(m_valid),
+        .m_axis_tready(m_ready),
+        .m_axis_tuser(m_user),
+        .m_axis_tlast(m_last)
+    );
+
+    // ----------------------------
+    // Instrumentation
+    // ----------------------------
+    integer cycle       = 0;   // clocks since reset release
+    integer first_in    = -1;  // cycle of the first input handshake
+    integer first_out   = -1;  // cycle of the first output handshake
+    integer last_out    = -1;
+    integer sof_prev    = -1;  // cycle of the previous output SOF
+    integer frame_cyc   = 0;   // last SOF-to-SOF distance
+
+    always @(posedge clk) begin
+        if (!rst) begin
+            cycle <= cycle + 1;
+
+            if (s_valid && s_ready) begin
+                if (first_in < 0) first_in <= cycle;
+                in_idx <= in_idx + 1;
+            end
+
+            if (m_valid && m_ready) begin
+                if (first_out < 0) first_out <= cycle;
+                last_out <= cycle;
+                if (m_user) begin
+                    if (sof_prev >= 0) frame_cyc <= cycle - sof_prev;
+                    sof_prev <= cycle;
+                end
+                if (m_user != (out_idx % N == 0) || m_last != (out_idx % W == W-1)) begin
+                    $display("Sideband mismatch at beat %0d", out_idx);
+                    errors = errors + 1;
+                end
+                if (m_data !== golden[out_addr]) begin
+                    if (errors < 10)
+                        $display("Frame %0d pixel (%0d,%0d): got %h, expected %h",
+                                 out_idx / N, out_idx % W, (out_idx % N) / W,
+                                 m_data, golden[out_addr]);
+                    errors = errors + 1;
+                end
+                out_idx <= out_idx + 1;
+            end
+
+            s_valid <= (in_idx + ((s_valid && s_ready) ? 1 : 0) < FRAMES*N) &&
+                       (!GAPS || $random % 4 != 0);
+            m_ready <= (!GAPS || $random % 4 != 0);
+        end
+    end
+
+    // ----------------------------
+    // Frame-buffer core (gs.v), one instance per configuration
+    // ----------------------------
+    // Configuration c is byte c of each list: PPC, ADD_PIPE, BORDER
+    localparam integer NCFG = 4;
+    localparam [8*NCFG-1:0] CFG_PPC      = {8'd1, 8'd4, 8'd2, 8'd1};
+    localparam [8*NCFG-1:0] CFG_ADD_PIPE = {8'd1, 8'd2, 8'd1, 8'd0};
+    localparam [8*NCFG-1:0] CFG_BORDER   = {8'd3, 8'd2, 8'd1, 8'd0};
+
+    wire [NCFG-1:0]    gs_checked;  // configuration c ran every frame
+    wire [32*NCFG-1:0] gs_errors;
+
+    // Integer-indexed bench code, waived like the reference above
+    /* verilator lint_off WIDTH */
+    genvar cfg;
+    generate
+        for (cfg = 0; cfg < NCFG; cfg = cfg + 1) begin : gs_cfg
+            localparam integer PPC_G      = CFG_PPC[8*cfg +: 8];
+            localparam integer ADD_PIPE_G = CFG_ADD_PIPE[8*cfg +: 8];
+            localparam integer BORDER_G   = CFG_BORDER[8*cfg +: 8];
+
+            reg     start   = 0;
+            wire    done;
+            reg     checked = 0;
+            integer gerr    = 0;
+
+            gaussian_blur_rgb565_320x240 #(
+                .LOAD_HEX(0),
+                .W(W),
+                .H(H),
+                .PPC(PPC_G),
+                .ADD_PIPE(ADD_PIPE_G),
+                .BORDER(BORDER_G)
+            ) dut (
+                .clk(clk),
+                .rst(rst),
+                .start(start),
+                .done(done)
+            );
+
+            assign gs_checked[cfg] = checked;
+            assign gs_errors[32*cfg +: 32] = gerr;
+
+            // One start per frame; done follows the last write
+            initial begin : run
+                integer gf, gi;
+                reg [15:0] want;
+                wait (!rst);
+                for (gf = 0; gf < FRAMES; gf = gf + 1) begin
+                    for (gi = 0; gi < N; gi = gi + 1)
+                        dut.frame_buffer[gi] = frame_buffer[gf*N + gi];
+                    @(posedge clk) start <= 1;
+                    @(posedge clk) start <= 0;
+                    wait (done);
+                    @(posedge clk);
+                    for (gi = 0; gi < N; gi = gi + 1) begin
+                        want = ref_pixel(gf, gi % W, gi / W, BORDER_G);
+                        if (dut.blur_buffer[gi] !== want) begin
+                            if (gerr < 10)
+                                $display("gs.v PPC=%0d ADD_PIPE=%0d BORDER=%0d frame %0d pixel (%0d,%0d): got %h, expected %h",
+                                         PPC_G, ADD_PIPE_G, BORDER_G, gf, gi % W, gi / W,
+                                         dut.blur_buffer[gi], want);
+                            gerr = gerr + 1;
+                        end
+                    end
+                end
+                $display("gaussian_blur_rgb565_320x240 PPC=%0d ADD_PIPE=%0d BORDER=%0d: %0d frames, %0d errors",
+                         PPC_G, ADD_PIPE_G, BORDER_G, FRAMES, gerr);
+                checked = 1;
+            end
+        end
+    endgenerate
+    /* verilator lint_on WIDTH */
+
+    // Runs alongside the wait() below, which would otherwise hang the
+    // job forever if the DUT drops or never emits a beat
+    always @(posedge clk) begin
+        if (!rst && cycle >= MAX_CYCLES)
+            $fatal(1, "Timeout: %0d of %0d beats, gs.v configurations done %b, after %0d cycles",
+                   out_idx, FRAMES*N, gs_checked, cycle);
+    end
+
+    integer total;
+    integer gs_total = 0;  // gs.v mismatches, all configurations
+    integer c;
+
+    initial begin
+        #30 rst = 0;
+
+        wait(out_idx == FRAMES*N);
+        wait(&gs_checked);
+        @(posedge clk);
+        for (c = 0; c < NCFG; c = c + 1)
+            gs_total = gs_total + gs_errors[32*c +: 32];
+
+        total = last_out - first_in + 1;
+        $display("gaussian_blur_rgb565_axis %0dx%0d, %0d frames%s",
+                 W, H, FRAMES, GAPS ? " (with gaps)" : "");
+        $display("  cycles/frame : %0d (%0d pixels)", frame_cyc, N);
+        $display("  pixels/clock : %0d.%03d", (FRAMES*N) / total,
+                 ((FRAMES*N) % total) * 1000 / total);
+        $display("  latency      : %0d cycles (first in -> first out)",
+                 first_out - first_in);
+        $display("  total        : %0d cycles", total);
+
+        // Mismatches must fail the run (non-zero exit), like the watchdog
+        if (errors != 0 || gs_total != 0)
+            $fatal(1, "FAIL: %0d errors (axis %0d, gs.v %0d)",
+                   errors + gs_total, errors, gs_total);
+        $display("PASS");
+        #20 $finish;
+    end
+
+endmodule
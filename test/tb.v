@@ -10,8 +10,22 @@ module tb_gaussian_blur;
     localparam INFILE  = "output.hex";
     localparam OUTFILE = "blurred.hex";
 
+    // Frame geometry; override to match bmp_to_hex --size=WxH
+    // (and pass the same --size to convert, as $writememh adds
+    // no geometry header)
+    parameter integer W = 320;
+    parameter integer H = 240;
+    parameter integer PPC = 1;       // pixels per clock
+    parameter integer ADD_PIPE = 0;  // adder-tree register levels
+    parameter integer BORDER = 0;    // 0 pass, 1 replicate, 2 mirror, 3 zero
+
     gaussian_blur_rgb565_320x240 #(
-        .IN_HEX(INFILE)
+        .IN_HEX(INFILE),
+        .W(W),
+        .H(H),
+        .PPC(PPC),
+        .ADD_PIPE(ADD_PIPE),
+        .BORDER(BORDER)
     ) dut (
         .clk(clk),
         .rst(rst),